@@ -1,5 +1,57 @@
 #include "FArray3D.h"
 
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/**
+	 * Divides by a divisor fixed for a whole batch with a multiplication and a shift, exact for every dividend from 0 to MAX_int32.
+	 * The dividend only needs 31 bits, which keeps the magic number within 32 bits so the product is a plain 32x32 to 64 bit multiplication the compiler can vectorize.
+	 */
+	struct FMagicDivisor
+	{
+		explicit FMagicDivisor(uint32 Divisor)
+		{
+			Shift = 31 + FMath::CeilLogTwo(Divisor);
+			Magic = static_cast<uint32>(((uint64(1) << Shift) + Divisor - 1) / Divisor);
+		}
+
+		FORCEINLINE uint32 Divide(uint32 Dividend) const { return static_cast<uint32>((uint64(Dividend) * Magic) >> Shift); }
+
+#if PLATFORM_CPU_X86_FAMILY
+		/**
+		 * Divides four dividends at once, _mm_mul_epu32 does the 32x32 to 64 bit multiplication of the even lanes so the odd lanes are shifted down for a second one.
+		 */
+		FORCEINLINE __m128i Divide(__m128i Dividends) const
+		{
+			const __m128i MagicVector = _mm_set1_epi32(static_cast<int32>(Magic));
+			const __m128i ShiftVector = _mm_cvtsi32_si128(static_cast<int32>(Shift));
+			const __m128i Even = _mm_srl_epi64(_mm_mul_epu32(Dividends, MagicVector), ShiftVector);
+			const __m128i Odd = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(Dividends, 32), MagicVector), ShiftVector);
+			// Every quotient fits in the low half of its 64 bit lane.
+			return _mm_or_si128(Even, _mm_slli_epi64(Odd, 32));
+		}
+#endif
+
+	private:
+		uint32 Magic;
+		uint32 Shift;
+	};
+
+#if PLATFORM_CPU_X86_FAMILY
+	/**
+	 * Multiplies four lanes by the same factor keeping the low 32 bits, SSE2 has no _mm_mullo_epi32.
+	 */
+	FORCEINLINE __m128i MultiplyLow(__m128i A, __m128i Factor)
+	{
+		const __m128i Even = _mm_mul_epu32(A, Factor);
+		const __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(A, 32), Factor);
+		return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	}
+#endif
+}
 
 int32 FArray3D::TranslateTo1D(int32 DX, int32 DY, int32 DZ, int32 X, int32 Y, int32 Z)
 {
@@ -39,23 +91,148 @@ FIntVector FArray3D::TranslateTo3D(FIntVector Dimensions, int32 I)
 	return TranslateTo3D(Dimensions.X, Dimensions.Y, Dimensions.Z, I);
 }
 
+int64 FArray3D::TranslateTo1D64(FIntVector Dimensions, FIntVector XYZ)
+{
+	verify(ValidateDimensions64(Dimensions));
+	verify(IndexWithinDimensions(Dimensions.X, Dimensions.Y, Dimensions.Z, XYZ.X, XYZ.Y, XYZ.Z));
+
+	return (int64(XYZ.Z) * Dimensions.Y + XYZ.Y) * Dimensions.X + XYZ.X;
+}
+
+FIntVector FArray3D::TranslateTo3D64(FIntVector Dimensions, int64 I)
+{
+	verify(ValidateDimensions64(Dimensions));
+	verify(IndexWithinDimensions64(Dimensions, I));
+
+	const int64 DXY = int64(Dimensions.X) * Dimensions.Y;
+	const int64 Z = I / DXY; // Find Z Index.
+	I -= DXY * Z; // Remove the Z dimension from the Index.
+
+	return FIntVector(static_cast<int32>(I % Dimensions.X), static_cast<int32>(I / Dimensions.X), static_cast<int32>(Z));
+}
+
+bool FArray3D::TranslateTo1D(FIntVector Dimensions, TArrayView<const FIntVector> XYZ, TArrayView<int32> OutIndices)
+{
+	if (!ValidateDimensions(Dimensions)) return false;
+	if (!ensureAlwaysMsgf(XYZ.Num() == OutIndices.Num(), TEXT("Output has to be as long as the input. Input: %d Output: %d"), XYZ.Num(), OutIndices.Num())) return false;
+
+	// Negative indices wrap around to large unsigned ones so each axis is a single comparison.
+	bool bWithinDimensions = true;
+	for (const FIntVector& Index : XYZ)
+	{
+		bWithinDimensions &= static_cast<uint32>(Index.X) < static_cast<uint32>(Dimensions.X) && static_cast<uint32>(Index.Y) < static_cast<uint32>(Dimensions.Y) && static_cast<uint32>(Index.Z) < static_cast<uint32>(Dimensions.Z);
+	}
+	if (!bWithinDimensions)
+	{
+		for (const FIntVector& Index : XYZ)
+		{
+			if (!IndexWithinDimensions(Dimensions.X, Dimensions.Y, Dimensions.Z, Index.X, Index.Y, Index.Z)) return false;
+		}
+	}
+
+	const int32 DX = Dimensions.X;
+	const int32 DXY = Dimensions.X * Dimensions.Y;
+	const FIntVector* RESTRICT In = XYZ.GetData();
+	int32* RESTRICT Out = OutIndices.GetData();
+	for (int32 Index = 0; Index < XYZ.Num(); ++Index)
+	{
+		Out[Index] = In[Index].Z * DXY + In[Index].Y * DX + In[Index].X;
+	}
+	return true;
+}
+
+bool FArray3D::TranslateTo3D(FIntVector Dimensions, TArrayView<const int32> Indices, TArrayView<FIntVector> OutXYZ)
+{
+	if (!ValidateDimensions(Dimensions)) return false;
+	if (!ensureAlwaysMsgf(Indices.Num() == OutXYZ.Num(), TEXT("Output has to be as long as the input. Input: %d Output: %d"), Indices.Num(), OutXYZ.Num())) return false;
+
+	// Negative indices wrap around to large unsigned ones, so the largest unsigned index is the only one that needs checking.
+	uint32 MaxIndex = 0;
+	for (const int32 I : Indices)
+	{
+		MaxIndex = FMath::Max(MaxIndex, static_cast<uint32>(I));
+	}
+	if (Indices.Num() > 0 && !IndexWithinDimensions(Dimensions.X, Dimensions.Y, Dimensions.Z, static_cast<int32>(MaxIndex))) return false;
+
+	const uint32 DX = static_cast<uint32>(Dimensions.X);
+	const uint32 DXY = static_cast<uint32>(Dimensions.X * Dimensions.Y);
+	const FMagicDivisor DivideByRow(DX);
+	const FMagicDivisor DivideBySlice(DXY);
+	const int32* RESTRICT In = Indices.GetData();
+	FIntVector* RESTRICT Out = OutXYZ.GetData();
+	int32 Index = 0;
+
+#if PLATFORM_CPU_X86_FAMILY
+	// Four indices per iteration, only writing the interleaved FIntVectors is left scalar.
+	const __m128i DXVector = _mm_set1_epi32(static_cast<int32>(DX));
+	const __m128i DXYVector = _mm_set1_epi32(static_cast<int32>(DXY));
+	for (; Index + 4 <= Indices.Num(); Index += 4)
+	{
+		const __m128i I = _mm_loadu_si128(reinterpret_cast<const __m128i*>(In + Index));
+		const __m128i Z = DivideBySlice.Divide(I);
+		const __m128i Rest = _mm_sub_epi32(I, MultiplyLow(Z, DXYVector));
+		const __m128i Y = DivideByRow.Divide(Rest);
+		const __m128i X = _mm_sub_epi32(Rest, MultiplyLow(Y, DXVector));
+
+		alignas(16) int32 Xs[4], Ys[4], Zs[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(Xs), X);
+		_mm_store_si128(reinterpret_cast<__m128i*>(Ys), Y);
+		_mm_store_si128(reinterpret_cast<__m128i*>(Zs), Z);
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			Out[Index + Lane] = FIntVector(Xs[Lane], Ys[Lane], Zs[Lane]);
+		}
+	}
+#endif
+
+	for (; Index < Indices.Num(); ++Index)
+	{
+		const uint32 I = static_cast<uint32>(In[Index]);
+		const uint32 Z = DivideBySlice.Divide(I);
+		const uint32 Rest = I - Z * DXY;
+		const uint32 Y = DivideByRow.Divide(Rest);
+		Out[Index] = FIntVector(static_cast<int32>(Rest - Y * DX), static_cast<int32>(Y), static_cast<int32>(Z));
+	}
+	return true;
+}
+
 int32 FArray3D::Size(int32 DX, int32 DY, int32 DZ)
 {
+	checkSlow(Size64(DX, DY, DZ) <= MAX_int32);
 	return DX * DY * DZ; // Size is the dimensions multiplied together.
 }
 int32 FArray3D::Size(FIntVector Dimensions)
 {
 	return Size(Dimensions.X, Dimensions.Y, Dimensions.Z);
 }
+int64 FArray3D::Size64(int32 DX, int32 DY, int32 DZ)
+{
+	return int64(DX) * DY * DZ;
+}
+int64 FArray3D::Size64(FIntVector Dimensions)
+{
+	return Size64(Dimensions.X, Dimensions.Y, Dimensions.Z);
+}
 
 bool FArray3D::ValidateDimensions(int32 DX, int32 DY, int32 DZ)
 {
-	return ensureAlwaysMsgf(DX > 0 && DY > 0 && DZ > 0, TEXT("Invalid dimensions, all dimensions need to be greater than 0. Dimensions:[%d, %d, %d]"), DX, DY, DZ);
+	return ValidateDimensions64(DX, DY, DZ) && ensureAlwaysMsgf(Size64(DX, DY, DZ) <= MAX_int32, TEXT("Invalid dimensions, the number of cells doesn't fit in int32. Dimensions:[%d, %d, %d]"), DX, DY, DZ);
 }
 bool FArray3D::ValidateDimensions(FIntVector Dimensions)
 {
 	return ValidateDimensions(Dimensions.X, Dimensions.Y, Dimensions.Z);
 }
+bool FArray3D::ValidateDimensions64(int32 DX, int32 DY, int32 DZ)
+{
+	if (!ensureAlwaysMsgf(DX > 0 && DY > 0 && DZ > 0, TEXT("Invalid dimensions, all dimensions need to be greater than 0. Dimensions:[%d, %d, %d]"), DX, DY, DZ)) return false;
+
+	// The product of two int32 always fits in int64, the third multiplication is checked with a division so it can't overflow while checking.
+	return ensureAlwaysMsgf(int64(DX) * DY <= MAX_int64 / DZ, TEXT("Invalid dimensions, the number of cells doesn't fit in int64. Dimensions:[%d, %d, %d]"), DX, DY, DZ);
+}
+bool FArray3D::ValidateDimensions64(FIntVector Dimensions)
+{
+	return ValidateDimensions64(Dimensions.X, Dimensions.Y, Dimensions.Z);
+}
 
 bool FArray3D::IndexWithinDimensions(int32 DX, int32 DY, int32 DZ, int32 X, int32 Y, int32 Z)
 {
@@ -64,4 +241,8 @@ bool FArray3D::IndexWithinDimensions(int32 DX, int32 DY, int32 DZ, int32 X, int3
 bool FArray3D::IndexWithinDimensions(int32 DX, int32 DY, int32 DZ, int32 I)
 {
 	return ensureAlwaysMsgf(I >= 0 && I < Size(DX, DY, DZ), TEXT("Index is not within the 1D bounds of the dimension. 1D bounds: 0 - %d Index: %d"), Size(DX,DY,DZ), I);
+}
+bool FArray3D::IndexWithinDimensions64(FIntVector Dimensions, int64 I)
+{
+	return ensureAlwaysMsgf(I >= 0 && I < Size64(Dimensions), TEXT("Index is not within the 1D bounds of the dimension. 1D bounds: 0 - %lld Index: %lld"), Size64(Dimensions), I);
 }
\ No newline at end of file
@@ -0,0 +1,182 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FArray3D.h"
+
+/**
+ * Memory layouts for TArray3D, each maps a 3D index to the index of the element in storage.
+ * Axes are passed as 0, 1 and 2 for X, Y and Z so the layouts can keep their steps in plain arrays.
+ *
+ * A layout provides:
+ * Init(Dimensions) - Sets up the layout, returns false if it can't hold the dimensions.
+ * Num() - The number of elements in storage, which is more than the cells for layouts that round the dimensions up.
+ * ToIndex(X, Y, Z) - The storage index of a cell.
+ * ToPosition(Index) - The cell at a storage index, only valid for indices of cells.
+ * Next(Index, Axis, Coordinate) - The storage index of the neighbour one step further along Axis from the cell at Index, whose coordinate along Axis is Coordinate.
+ */
+
+/**
+ * Row-major with X as the fastest axis, the same order as FArray3D. X lines are contiguous, Z lines step over a whole slice per cell.
+ */
+struct FArray3DRowMajorLayout
+{
+	bool Init(FIntVector Dimensions)
+	{
+		Strides[0] = 1;
+		Strides[1] = Dimensions.X;
+		Strides[2] = Dimensions.X * Dimensions.Y;
+		Size = FArray3D::Size(Dimensions);
+		return true;
+	}
+
+	int32 Num() const { return Size; }
+	FORCEINLINE int32 ToIndex(int32 X, int32 Y, int32 Z) const { return Z * Strides[2] + Y * Strides[1] + X; }
+	FIntVector ToPosition(int32 Index) const { return FIntVector(Index % Strides[1], (Index % Strides[2]) / Strides[1], Index / Strides[2]); }
+	FORCEINLINE int32 Next(int32 Index, int32 Axis, int32 Coordinate) const { return Index + Strides[Axis]; }
+
+private:
+	int32 Strides[3] = { 0, 0, 0 };
+	int32 Size = 0;
+};
+
+/**
+ * Morton (Z-order) with the bits of X, Y and Z interleaved, so cells that are close in any direction are close in memory.
+ * Every axis is rounded up to a power of two and an axis that runs out of bits stops taking part in the interleaving, so flat grids don't pay for a cube.
+ */
+struct FArray3DMortonLayout
+{
+	bool Init(FIntVector Dimensions)
+	{
+		int32 AxisBits[3];
+		int32 TotalBits = 0;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			AxisBits[Axis] = FMath::CeilLogTwo(static_cast<uint32>(Dimensions[Axis]));
+			TotalBits += AxisBits[Axis];
+			Masks[Axis] = 0;
+		}
+		if (!ensureAlwaysMsgf(TotalBits <= 30, TEXT("Dimensions too large for a Morton layout. Dimensions:[%d, %d, %d]"), Dimensions.X, Dimensions.Y, Dimensions.Z)) return false;
+
+		// Hands out the bits of the index round robin to the axes that still have bits left.
+		int32 OutBit = 0;
+		for (int32 Bit = 0; OutBit < TotalBits; ++Bit)
+		{
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				if (Bit < AxisBits[Axis])
+				{
+					Masks[Axis] |= 1u << OutBit++;
+				}
+			}
+		}
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Tables[Axis].SetNumUninitialized(Dimensions[Axis]);
+			for (int32 Coordinate = 0; Coordinate < Dimensions[Axis]; ++Coordinate)
+			{
+				Tables[Axis][Coordinate] = static_cast<int32>(Deposit(static_cast<uint32>(Coordinate), Masks[Axis]));
+			}
+		}
+		Size = 1 << TotalBits;
+		return true;
+	}
+
+	int32 Num() const { return Size; }
+	FORCEINLINE int32 ToIndex(int32 X, int32 Y, int32 Z) const { return Tables[0].GetData()[X] | Tables[1].GetData()[Y] | Tables[2].GetData()[Z]; }
+	FIntVector ToPosition(int32 Index) const { return FIntVector(Extract(Index, Masks[0]), Extract(Index, Masks[1]), Extract(Index, Masks[2])); }
+	FORCEINLINE int32 Next(int32 Index, int32 Axis, int32 Coordinate) const
+	{
+		// Setting every bit outside the mask makes the carry of the increment ripple straight through to the next bit of the axis.
+		const uint32 Mask = Masks[Axis];
+		const uint32 Bits = static_cast<uint32>(Index);
+		return static_cast<int32>((((Bits | ~Mask) + 1) & Mask) | (Bits & ~Mask));
+	}
+
+private:
+	static uint32 Deposit(uint32 Value, uint32 Mask)
+	{
+		uint32 Result = 0;
+		for (uint32 Bit = 1; Mask != 0; Bit <<= 1, Mask &= Mask - 1)
+		{
+			if (Value & Bit)
+			{
+				Result |= Mask & (~Mask + 1);
+			}
+		}
+		return Result;
+	}
+	static int32 Extract(int32 Index, uint32 Mask)
+	{
+		uint32 Result = 0;
+		for (uint32 Bit = 1; Mask != 0; Bit <<= 1, Mask &= Mask - 1)
+		{
+			if (static_cast<uint32>(Index) & Mask & (~Mask + 1))
+			{
+				Result |= Bit;
+			}
+		}
+		return static_cast<int32>(Result);
+	}
+
+	// The bits of the storage index that belong to each axis and the deposited bits of every coordinate.
+	uint32 Masks[3] = { 0, 0, 0 };
+	TArray<int32> Tables[3];
+	int32 Size = 0;
+};
+
+/**
+ * Cubic bricks of BrickSize^3 cells stored one after another, row-major inside a brick and between bricks.
+ * A line along any axis stays within one brick for BrickSize cells, so Z lines and XZ or YZ slices touch far fewer cache lines than row-major.
+ */
+template<int32 BrickSize = 4>
+struct TArray3DBrickLayout
+{
+	static_assert(BrickSize > 1 && (BrickSize & (BrickSize - 1)) == 0, "BrickSize must be a power of two.");
+
+	static constexpr int32 Shift = BrickSize == 2 ? 1 : BrickSize == 4 ? 2 : BrickSize == 8 ? 3 : BrickSize == 16 ? 4 : 5;
+	static constexpr int32 Mask = BrickSize - 1;
+	static_assert((1 << Shift) == BrickSize, "BrickSize must be at most 32.");
+
+	bool Init(FIntVector Dimensions)
+	{
+		BricksX = (Dimensions.X + Mask) >> Shift;
+		BricksY = (Dimensions.Y + Mask) >> Shift;
+		const int32 BricksZ = (Dimensions.Z + Mask) >> Shift;
+		BrickStrides[0] = 1 << (3 * Shift);
+		BrickStrides[1] = BricksX << (3 * Shift);
+		BrickStrides[2] = (BricksX * BricksY) << (3 * Shift);
+		Size = BricksX * BricksY * BricksZ << (3 * Shift);
+		return true;
+	}
+
+	int32 Num() const { return Size; }
+	FORCEINLINE int32 ToIndex(int32 X, int32 Y, int32 Z) const
+	{
+		const int32 Brick = ((Z >> Shift) * BricksY + (Y >> Shift)) * BricksX + (X >> Shift);
+		return (Brick << (3 * Shift)) | ((Z & Mask) << (2 * Shift)) | ((Y & Mask) << Shift) | (X & Mask);
+	}
+	FIntVector ToPosition(int32 Index) const
+	{
+		const int32 Brick = Index >> (3 * Shift);
+		const int32 Local = Index & ((1 << (3 * Shift)) - 1);
+		return FIntVector(
+			((Brick % BricksX) << Shift) | (Local & Mask),
+			(((Brick / BricksX) % BricksY) << Shift) | ((Local >> Shift) & Mask),
+			((Brick / (BricksX * BricksY)) << Shift) | (Local >> (2 * Shift)));
+	}
+	FORCEINLINE int32 Next(int32 Index, int32 Axis, int32 Coordinate) const
+	{
+		// Within a brick it's a local step, leaving one moves to the start of the next brick along the axis.
+		const int32 LocalStride = 1 << (Axis * Shift);
+		return ((Coordinate + 1) & Mask) ? Index + LocalStride : Index + BrickStrides[Axis] - Mask * LocalStride;
+	}
+
+private:
+	int32 BricksX = 0;
+	int32 BricksY = 0;
+	int32 BrickStrides[3] = { 0, 0, 0 };
+	int32 Size = 0;
+};
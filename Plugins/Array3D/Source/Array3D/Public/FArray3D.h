@@ -3,6 +3,7 @@
 #pragma once
 
 #include "HAL/Platform.h"
+#include "Containers/ArrayView.h"
 #include "Math/IntVector.h"
 
 class ARRAY3D_API FArray3D
@@ -55,6 +56,39 @@ public:
 	 */
 	static FIntVector TranslateTo3D(FIntVector Dimensions, int32 I);
 
+	/**
+	 * Converts a 3D Index (X,Y,Z) into a 1D Index for dimensions validated with ValidateDimensions64, whose Size may not fit in int32.
+	 * @param Dimensions - Size of the dimensions.
+	 * @param XYZ - Index in the 3D-dimensions.
+	 * @returns a 1D Index >= 0 and < Size64(Dimensions).
+	 */
+	static int64 TranslateTo1D64(FIntVector Dimensions, FIntVector XYZ);
+	/**
+	 * Converts a 1D Index into a 3D Index (X,Y,Z) for dimensions validated with ValidateDimensions64, whose Size may not fit in int32.
+	 * @param Dimensions - Size of the dimensions.
+	 * @param I - 1D Index to convert to 3D Index.
+	 * @returns a 3D Index within Dimensions.
+	 */
+	static FIntVector TranslateTo3D64(FIntVector Dimensions, int64 I);
+
+	/**
+	 * Converts many 3D Indices into 1D Indices, validating the dimensions and the indices once for the whole batch instead of per index.
+	 * @param Dimensions - Size of the dimensions.
+	 * @param XYZ - 3D Indices to convert.
+	 * @param OutIndices - Receives the 1D Index of every 3D Index, has to be as long as XYZ.
+	 * @returns true if every index was converted, false if the dimensions or any index is invalid in which case OutIndices is untouched.
+	 */
+	static bool TranslateTo1D(FIntVector Dimensions, TArrayView<const FIntVector> XYZ, TArrayView<int32> OutIndices);
+	/**
+	 * Converts many 1D Indices into 3D Indices, validating the dimensions and the indices once for the whole batch instead of per index.
+	 * The divisions by the dimensions are replaced with multiplications by magic numbers calculated once per batch, four indices at a time with SSE2 on x86.
+	 * @param Dimensions - Size of the dimensions.
+	 * @param Indices - 1D Indices to convert.
+	 * @param OutXYZ - Receives the 3D Index of every 1D Index, has to be as long as Indices.
+	 * @returns true if every index was converted, false if the dimensions or any index is invalid in which case OutXYZ is untouched.
+	 */
+	static bool TranslateTo3D(FIntVector Dimensions, TArrayView<const int32> Indices, TArrayView<FIntVector> OutXYZ);
+
 	/**
 	 * Gets the Size of the 3D array as in the number of cells/elements.
 	 * @param DX - Size of the X-dimension.
@@ -69,9 +103,23 @@ public:
 	 * @returns the product of all dimensions.
 	 */
 	static int32 Size(FIntVector Dimensions);
+	/**
+	 * Gets the Size of the 3D array as in the number of cells/elements without overflowing int32, the dimensions have to be validated with ValidateDimensions64 first.
+	 * @param DX - Size of the X-dimension.
+	 * @param DY - Size of the Y-dimension.
+	 * @param DZ - Size of the Z-dimension.
+	 * @returns DX*DY*DZ.
+	 */
+	static int64 Size64(int32 DX, int32 DY, int32 DZ);
+	/**
+	 * Gets the Size of the 3D array as in the number of cells/elements without overflowing int32, the dimensions have to be validated with ValidateDimensions64 first.
+	 * @param Dimensions - Size of the dimensions.
+	 * @returns the product of all dimensions.
+	 */
+	static int64 Size64(FIntVector Dimensions);
 
 	/**
-	 * Validates the given dimensions, making sure they are all larger than 0.
+	 * Validates the given dimensions, making sure they are all larger than 0 and that Size fits in int32.
 	 * @param DX - Size of the X-dimension.
 	 * @param DY - Size of the Y-dimension.
 	 * @param DZ - Size of the Z-dimension.
@@ -79,11 +127,25 @@ public:
 	 */
 	static bool ValidateDimensions(int32 DX, int32 DY, int32 DZ);
 	/**
-	 * Validates the given dimensions, making sure X, Y & Z are all larger than 0.
+	 * Validates the given dimensions, making sure X, Y & Z are all larger than 0 and that Size fits in int32.
 	 * @param Dimensions - The dimensions (X,Y,Z) to check.
 	 * @returns true if dimensions are valid otherwise false.
 	 */
 	static bool ValidateDimensions(FIntVector Dimensions);
+	/**
+	 * Validates the given dimensions for the 64-bit functions, making sure they are all larger than 0 and that Size64 fits in int64.
+	 * @param DX - Size of the X-dimension.
+	 * @param DY - Size of the Y-dimension.
+	 * @param DZ - Size of the Z-dimension.
+	 * @returns true if dimensions are valid otherwise false.
+	 */
+	static bool ValidateDimensions64(int32 DX, int32 DY, int32 DZ);
+	/**
+	 * Validates the given dimensions for the 64-bit functions, making sure X, Y & Z are all larger than 0 and that Size64 fits in int64.
+	 * @param Dimensions - The dimensions (X,Y,Z) to check.
+	 * @returns true if dimensions are valid otherwise false.
+	 */
+	static bool ValidateDimensions64(FIntVector Dimensions);
 
 	/**
 	 * Makes sure the given index is within the dimensions.
@@ -105,5 +167,12 @@ public:
 	 * @returns true if index is within the dimensions otherwise false.
 	 */
 	static bool IndexWithinDimensions(int32 DX, int32 DY, int32 DZ, int32 I);
+	/**
+	 * Makes sure the given index is within the 1D bounds of dimensions validated with ValidateDimensions64.
+	 * @param Dimensions - Size of the dimensions.
+	 * @param I - 1D Index.
+	 * @returns true if index is within the dimensions otherwise false.
+	 */
+	static bool IndexWithinDimensions64(FIntVector Dimensions, int64 I);
 	
 };
@@ -0,0 +1,401 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Array3DLayout.h"
+#include "FArray3D.h"
+
+namespace Array3D
+{
+	FORCEINLINE int32 ToAxisIndex(EAxis::Type Axis) { checkSlow(Axis != EAxis::None); return Axis == EAxis::X ? 0 : Axis == EAxis::Y ? 1 : 2; }
+}
+
+/**
+ * A run of cells along one axis of a TArray3D.
+ * The iterator steps through the layout, so a line costs the same per cell for X, Y and Z in row-major order as in any other layout.
+ */
+template<typename ElementType, typename LayoutType>
+class TArray3DLine
+{
+public:
+	class FIterator
+	{
+	public:
+		FIterator(ElementType* InData, const LayoutType* InLayout, int32 InIndex, int32 InAxis, int32 InCoordinate) : Data(InData), Layout(InLayout), Index(InIndex), Axis(InAxis), Coordinate(InCoordinate) {}
+
+		ElementType& operator*() const { return Data[Index]; }
+		ElementType* operator->() const { return Data + Index; }
+		FIterator& operator++()
+		{
+			Index = Layout->Next(Index, Axis, Coordinate++);
+			return *this;
+		}
+		bool operator==(const FIterator& Other) const { return Coordinate == Other.Coordinate; }
+		bool operator!=(const FIterator& Other) const { return Coordinate != Other.Coordinate; }
+
+	private:
+		ElementType* Data;
+		const LayoutType* Layout;
+		int32 Index;
+		int32 Axis;
+		// The end is found by the coordinate, the index past the last cell is never used.
+		int32 Coordinate;
+	};
+
+	TArray3DLine() : Data(nullptr), Layout(nullptr), Start(FIntVector::ZeroValue), Axis(0), Length(0) {}
+	/**
+	 * @param InStart - The first cell of the line, its coordinate along the axis has to be 0.
+	 */
+	TArray3DLine(ElementType* InData, const LayoutType* InLayout, FIntVector InStart, int32 InAxis, int32 InLength) : Data(InData), Layout(InLayout), Start(InStart), Axis(InAxis), Length(InLength) {}
+
+	int32 Num() const { return Length; }
+	bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < Length; }
+	FORCEINLINE ElementType& operator[](int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		FIntVector Position = Start;
+		Position[Axis] = Index;
+		return Data[Layout->ToIndex(Position.X, Position.Y, Position.Z)];
+	}
+
+	FIterator begin() const { return FIterator(Data, Layout, Length > 0 ? Layout->ToIndex(Start.X, Start.Y, Start.Z) : 0, Axis, 0); }
+	FIterator end() const { return FIterator(Data, Layout, 0, Axis, Length); }
+
+private:
+	ElementType* Data;
+	const LayoutType* Layout;
+	FIntVector Start;
+	int32 Axis;
+	int32 Length;
+};
+
+/**
+ * A plane of a TArray3D perpendicular to one axis, U and V are the two remaining axes in X, Y, Z order so U is always the faster one.
+ * Iterating walks V rows of U cells.
+ */
+template<typename ElementType, typename LayoutType>
+class TArray3DSlice
+{
+public:
+	class FIterator
+	{
+	public:
+		FIterator(const TArray3DSlice& InSlice, FIntVector InPosition)
+			: Data(InSlice.Data), Layout(InSlice.Layout), Position(InPosition), AxisU(InSlice.AxisU), AxisV(InSlice.AxisV), SizeU(InSlice.SizeU), SizeV(InSlice.SizeV)
+			, Index(InPosition[InSlice.AxisV] < InSlice.SizeV ? InSlice.Layout->ToIndex(InPosition.X, InPosition.Y, InPosition.Z) : 0)
+		{}
+
+		ElementType& operator*() const { return Data[Index]; }
+		ElementType* operator->() const { return Data + Index; }
+		FIterator& operator++()
+		{
+			if (Position[AxisU] + 1 < SizeU)
+			{
+				Index = Layout->Next(Index, AxisU, Position[AxisU]++);
+			}
+			else
+			{
+				Position[AxisU] = 0;
+				if (++Position[AxisV] < SizeV)
+				{
+					Index = Layout->ToIndex(Position.X, Position.Y, Position.Z);
+				}
+			}
+			return *this;
+		}
+		bool operator==(const FIterator& Other) const { return Position == Other.Position; }
+		bool operator!=(const FIterator& Other) const { return Position != Other.Position; }
+
+		FIntVector GetPosition() const { return Position; }
+
+	private:
+		// Copied from the slice so the iterator stays valid after a temporary slice goes away.
+		ElementType* Data;
+		const LayoutType* Layout;
+		FIntVector Position;
+		int32 AxisU;
+		int32 AxisV;
+		int32 SizeU;
+		int32 SizeV;
+		int32 Index;
+	};
+
+	TArray3DSlice() : Data(nullptr), Layout(nullptr), Start(FIntVector::ZeroValue), AxisU(0), AxisV(1), SizeU(0), SizeV(0) {}
+	/**
+	 * @param InStart - The first cell of the slice, its coordinates along U and V have to be 0.
+	 */
+	TArray3DSlice(ElementType* InData, const LayoutType* InLayout, FIntVector InStart, int32 InAxisU, int32 InAxisV, int32 InSizeU, int32 InSizeV)
+		: Data(InData), Layout(InLayout), Start(InStart), AxisU(InAxisU), AxisV(InAxisV), SizeU(InSizeU), SizeV(InSizeV)
+	{}
+
+	int32 Num() const { return SizeU * SizeV; }
+	int32 NumU() const { return SizeU; }
+	int32 NumV() const { return SizeV; }
+	bool IsValidIndex(int32 U, int32 V) const { return U >= 0 && U < SizeU && V >= 0 && V < SizeV; }
+	FORCEINLINE ElementType& operator()(int32 U, int32 V) const
+	{
+		checkSlow(IsValidIndex(U, V));
+		const FIntVector Position = ToPosition(U, V);
+		return Data[Layout->ToIndex(Position.X, Position.Y, Position.Z)];
+	}
+
+	/**
+	 * Gets the line along U at the given V.
+	 */
+	TArray3DLine<ElementType, LayoutType> GetRow(int32 V) const { checkSlow(V >= 0 && V < SizeV); return TArray3DLine<ElementType, LayoutType>(Data, Layout, ToPosition(0, V), AxisU, SizeU); }
+	/**
+	 * Gets the line along V at the given U.
+	 */
+	TArray3DLine<ElementType, LayoutType> GetColumn(int32 U) const { checkSlow(U >= 0 && U < SizeU); return TArray3DLine<ElementType, LayoutType>(Data, Layout, ToPosition(U, 0), AxisV, SizeV); }
+
+	FIterator begin() const { return Num() > 0 ? FIterator(*this, Start) : end(); }
+	FIterator end() const { return FIterator(*this, ToPosition(0, SizeV)); }
+
+private:
+	FIntVector ToPosition(int32 U, int32 V) const
+	{
+		FIntVector Position = Start;
+		Position[AxisU] = U;
+		Position[AxisV] = V;
+		return Position;
+	}
+
+	ElementType* Data;
+	const LayoutType* Layout;
+	FIntVector Start;
+	int32 AxisU;
+	int32 AxisV;
+	int32 SizeU;
+	int32 SizeV;
+};
+
+/**
+ * An inclusive sub-box of a TArray3D, iterated X fastest so in row-major order only the steps between rows leave the cache line.
+ * The iterator knows the position of the cell it's at, which replaces a separate TranslateTo3D per cell.
+ */
+template<typename ElementType, typename LayoutType>
+class TArray3DBox
+{
+public:
+	class FIterator
+	{
+	public:
+		/**
+		 * @param bAtCell - false for the end, whose position isn't a cell that the layout can map.
+		 */
+		FIterator(const TArray3DBox& InBox, FIntVector InPosition, bool bAtCell)
+			: Data(InBox.Data), Layout(InBox.Layout), Position(InPosition)
+			, MinX(InBox.Min.X), MaxX(InBox.Max.X), MinY(InBox.Min.Y), MaxY(InBox.Max.Y), MaxZ(InBox.Max.Z)
+			, Index(bAtCell ? InBox.Layout->ToIndex(InPosition.X, InPosition.Y, InPosition.Z) : 0)
+		{}
+
+		ElementType& operator*() const { return Data[Index]; }
+		ElementType* operator->() const { return Data + Index; }
+		FIterator& operator++()
+		{
+			if (Position.X < MaxX)
+			{
+				Index = Layout->Next(Index, 0, Position.X++);
+			}
+			else
+			{
+				Position.X = MinX;
+				if (++Position.Y > MaxY)
+				{
+					Position.Y = MinY;
+					++Position.Z;
+				}
+				if (Position.Z <= MaxZ)
+				{
+					Index = Layout->ToIndex(Position.X, Position.Y, Position.Z);
+				}
+			}
+			return *this;
+		}
+		bool operator==(const FIterator& Other) const { return Position == Other.Position; }
+		bool operator!=(const FIterator& Other) const { return Position != Other.Position; }
+
+		/** Gets the 3D index of the current cell in the whole array. */
+		FIntVector GetPosition() const { return Position; }
+		/** Gets the storage index of the current cell, the same as the FArray3D index for the row-major layout. */
+		int32 GetIndex() const { return Index; }
+
+	private:
+		// Copied from the box so the iterator stays valid after a temporary box goes away.
+		ElementType* Data;
+		const LayoutType* Layout;
+		FIntVector Position;
+		int32 MinX;
+		int32 MaxX;
+		int32 MinY;
+		int32 MaxY;
+		int32 MaxZ;
+		int32 Index;
+	};
+
+	TArray3DBox() : Data(nullptr), Layout(nullptr), Min(FIntVector::ZeroValue), Max(FIntVector(-1)) {}
+	/**
+	 * @param InMin - The first corner of the box, must be within the dimensions.
+	 * @param InMax - The last corner of the box, must be within the dimensions. A box with Max < Min in any axis is empty.
+	 */
+	TArray3DBox(ElementType* InData, const LayoutType* InLayout, FIntVector InMin, FIntVector InMax) : Data(InData), Layout(InLayout), Min(InMin), Max(InMax) {}
+
+	bool IsEmpty() const { return Max.X < Min.X || Max.Y < Min.Y || Max.Z < Min.Z; }
+	int32 Num() const { return IsEmpty() ? 0 : (Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1); }
+	FIntVector GetMin() const { return Min; }
+	FIntVector GetMax() const { return Max; }
+
+	FIterator begin() const { return IsEmpty() ? end() : FIterator(*this, Min, true); }
+	FIterator end() const { return FIterator(*this, IsEmpty() ? Min : FIntVector(Min.X, Min.Y, Max.Z + 1), false); }
+
+private:
+	ElementType* Data;
+	const LayoutType* Layout;
+	FIntVector Min;
+	FIntVector Max;
+};
+
+/**
+ * A 3D array owning its elements, laid out in memory by LayoutType.
+ * The default row-major layout matches FArray3D, FArray3DMortonLayout and TArray3DBrickLayout keep neighbours along every axis close in memory.
+ * Lines, slices and sub-boxes are views into the storage with the same API for every layout, walking them replaces hand written loops over FIntVector indices.
+ * Indexing is only checked in checkSlow builds, use IsValidIndex or FArray3D for input that isn't trusted.
+ * Only the puzzle generator and the benchmark commandlet use it so far. The grid, the solver and the numbers walk their lines with
+ * FPicrossLineLayout and FPicrossGridDispatch, and the block states live in a chunked array that TArray3D can't wrap.
+ */
+template<typename InElementType, typename InLayoutType = FArray3DRowMajorLayout, typename InAllocator = FDefaultAllocator>
+class TArray3D
+{
+public:
+	typedef InElementType ElementType;
+	typedef InLayoutType LayoutType;
+	typedef TArray<ElementType, InAllocator> ArrayType;
+
+	typedef TArray3DLine<ElementType, LayoutType> LineType;
+	typedef TArray3DLine<const ElementType, LayoutType> ConstLineType;
+	typedef TArray3DSlice<ElementType, LayoutType> SliceType;
+	typedef TArray3DSlice<const ElementType, LayoutType> ConstSliceType;
+	typedef TArray3DBox<ElementType, LayoutType> BoxType;
+	typedef TArray3DBox<const ElementType, LayoutType> ConstBoxType;
+
+	TArray3D() : Dimensions(FIntVector::ZeroValue) {}
+	explicit TArray3D(FIntVector InDimensions, const ElementType& Value = ElementType()) : Dimensions(FIntVector::ZeroValue) { Init(InDimensions, Value); }
+
+	/**
+	 * Resizes the array to the given dimensions with every element set to Value.
+	 * @returns false and leaves the array empty if the dimensions aren't valid or too large for the layout.
+	 */
+	bool Init(FIntVector InDimensions, const ElementType& Value = ElementType())
+	{
+		if (!FArray3D::ValidateDimensions(InDimensions) || !Layout.Init(InDimensions))
+		{
+			Empty();
+			return false;
+		}
+
+		Dimensions = InDimensions;
+		Elements.Init(Value, Layout.Num());
+		return true;
+	}
+	void Empty()
+	{
+		Dimensions = FIntVector::ZeroValue;
+		Layout = LayoutType();
+		Elements.Empty();
+	}
+
+	FIntVector GetDimensions() const { return Dimensions; }
+	int32 X() const { return Dimensions.X; }
+	int32 Y() const { return Dimensions.Y; }
+	int32 Z() const { return Dimensions.Z; }
+	/** Gets the number of cells, the storage can be larger for layouts that round the dimensions up. */
+	int32 Num() const { return FArray3D::Size(Dimensions); }
+	int32 Size(EAxis::Type Axis) const { return Dimensions[Array3D::ToAxisIndex(Axis)]; }
+	const LayoutType& GetLayout() const { return Layout; }
+
+	bool IsValidIndex(int32 InX, int32 InY, int32 InZ) const { return InX >= 0 && InX < Dimensions.X && InY >= 0 && InY < Dimensions.Y && InZ >= 0 && InZ < Dimensions.Z; }
+	bool IsValidIndex(FIntVector XYZ) const { return IsValidIndex(XYZ.X, XYZ.Y, XYZ.Z); }
+
+	/**
+	 * Gets the storage index of a cell, the same as the FArray3D index for the row-major layout.
+	 */
+	FORCEINLINE int32 GetIndex(int32 InX, int32 InY, int32 InZ) const { checkSlow(IsValidIndex(InX, InY, InZ)); return Layout.ToIndex(InX, InY, InZ); }
+	FORCEINLINE int32 GetIndex(FIntVector XYZ) const { return GetIndex(XYZ.X, XYZ.Y, XYZ.Z); }
+	/**
+	 * Gets the cell at a storage index, only valid for storage indices of cells.
+	 */
+	FIntVector GetPosition(int32 Index) const { checkSlow(Elements.IsValidIndex(Index)); return Layout.ToPosition(Index); }
+
+	FORCEINLINE ElementType& operator()(int32 InX, int32 InY, int32 InZ) { return Elements.GetData()[GetIndex(InX, InY, InZ)]; }
+	FORCEINLINE const ElementType& operator()(int32 InX, int32 InY, int32 InZ) const { return Elements.GetData()[GetIndex(InX, InY, InZ)]; }
+	FORCEINLINE ElementType& operator[](FIntVector XYZ) { return Elements.GetData()[GetIndex(XYZ)]; }
+	FORCEINLINE const ElementType& operator[](FIntVector XYZ) const { return Elements.GetData()[GetIndex(XYZ)]; }
+
+	ElementType* GetData() { return Elements.GetData(); }
+	const ElementType* GetData() const { return Elements.GetData(); }
+	/** Gets the elements in storage order, for code that still works on 1D indices. Only the row-major layout has no padding. */
+	const ArrayType& GetArray() const { return Elements; }
+
+	/**
+	 * Gets the line along Axis through the given position, the coordinate of Through along Axis is ignored.
+	 */
+	LineType GetLine(EAxis::Type Axis, FIntVector Through) { return MakeLine<ElementType>(GetData(), Axis, Through); }
+	ConstLineType GetLine(EAxis::Type Axis, FIntVector Through) const { return MakeLine<const ElementType>(GetData(), Axis, Through); }
+
+	/**
+	 * Gets the plane perpendicular to Axis at the given index along it.
+	 * U and V are Y and Z for an X slice, X and Z for a Y slice and X and Y for a Z slice.
+	 */
+	SliceType GetSlice(EAxis::Type Axis, int32 Index) { return MakeSlice<ElementType>(GetData(), Axis, Index); }
+	ConstSliceType GetSlice(EAxis::Type Axis, int32 Index) const { return MakeSlice<const ElementType>(GetData(), Axis, Index); }
+
+	/**
+	 * Gets the inclusive box between Min and Max, clamped to the dimensions.
+	 */
+	BoxType GetBox(FIntVector Min, FIntVector Max) { return BoxType(GetData(), &Layout, ClampMin(Min), ClampMax(Max)); }
+	ConstBoxType GetBox(FIntVector Min, FIntVector Max) const { return ConstBoxType(GetData(), &Layout, ClampMin(Min), ClampMax(Max)); }
+	/**
+	 * Gets the box of the whole array, for iterating every cell along with its position.
+	 */
+	BoxType GetBox() { return GetBox(FIntVector::ZeroValue, Dimensions - FIntVector(1)); }
+	ConstBoxType GetBox() const { return GetBox(FIntVector::ZeroValue, Dimensions - FIntVector(1)); }
+
+	// Ranged-for over every cell X fastest, which skips the padding of layouts that have it.
+	typename BoxType::FIterator begin() { return GetBox().begin(); }
+	typename BoxType::FIterator end() { return GetBox().end(); }
+	typename ConstBoxType::FIterator begin() const { return GetBox().begin(); }
+	typename ConstBoxType::FIterator end() const { return GetBox().end(); }
+
+	bool operator==(const TArray3D& Other) const { return Dimensions == Other.Dimensions && Elements == Other.Elements; }
+	bool operator!=(const TArray3D& Other) const { return !(*this == Other); }
+
+private:
+	template<typename ViewElementType>
+	TArray3DLine<ViewElementType, LayoutType> MakeLine(ViewElementType* Data, EAxis::Type Axis, FIntVector Through) const
+	{
+		const int32 AxisIndex = Array3D::ToAxisIndex(Axis);
+		Through[AxisIndex] = 0;
+		checkSlow(IsValidIndex(Through));
+		return TArray3DLine<ViewElementType, LayoutType>(Data, &Layout, Through, AxisIndex, Dimensions[AxisIndex]);
+	}
+
+	template<typename ViewElementType>
+	TArray3DSlice<ViewElementType, LayoutType> MakeSlice(ViewElementType* Data, EAxis::Type Axis, int32 Index) const
+	{
+		const int32 AxisIndex = Array3D::ToAxisIndex(Axis);
+		checkSlow(Index >= 0 && Index < Dimensions[AxisIndex]);
+		const int32 AxisU = AxisIndex == 0 ? 1 : 0;
+		const int32 AxisV = AxisIndex == 2 ? 1 : 2;
+		FIntVector Start = FIntVector::ZeroValue;
+		Start[AxisIndex] = Index;
+		return TArray3DSlice<ViewElementType, LayoutType>(Data, &Layout, Start, AxisU, AxisV, Dimensions[AxisU], Dimensions[AxisV]);
+	}
+
+	FIntVector ClampMin(FIntVector Min) const { return FIntVector(FMath::Max(Min.X, 0), FMath::Max(Min.Y, 0), FMath::Max(Min.Z, 0)); }
+	FIntVector ClampMax(FIntVector Max) const { return FIntVector(FMath::Min(Max.X, Dimensions.X - 1), FMath::Min(Max.Y, Dimensions.Y - 1), FMath::Min(Max.Z, Dimensions.Z - 1)); }
+
+	FIntVector Dimensions;
+	LayoutType Layout;
+	ArrayType Elements;
+};
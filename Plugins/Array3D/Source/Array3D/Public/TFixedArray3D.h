@@ -0,0 +1,51 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Index math of FArray3D for dimensions known at compile time.
+ * Every multiply and divide is by a constant so the compiler turns them into shifts and multiplications, and nothing is validated outside of checkSlow.
+ * FDynamicArray3D has the same interface for dimensions only known at runtime, so code templated on the dimensions works with both.
+ */
+template<int32 InDX, int32 InDY, int32 InDZ>
+struct TFixedArray3D
+{
+	static_assert(InDX > 0 && InDY > 0 && InDZ > 0, "All dimensions need to be greater than 0.");
+
+	static constexpr int32 DX = InDX;
+	static constexpr int32 DY = InDY;
+	static constexpr int32 DZ = InDZ;
+
+	TFixedArray3D() = default;
+	/** Lets code templated on the dimensions construct either kind from the runtime size. */
+	explicit TFixedArray3D(FIntVector Dimensions) { checkSlow(Dimensions == GetDimensions()); }
+
+	static FIntVector GetDimensions() { return FIntVector(DX, DY, DZ); }
+	static constexpr int32 Size() { return DX * DY * DZ; }
+	static constexpr bool IndexWithinDimensions(int32 X, int32 Y, int32 Z) { return X >= 0 && X < DX && Y >= 0 && Y < DY && Z >= 0 && Z < DZ; }
+
+	static FORCEINLINE int32 TranslateTo1D(int32 X, int32 Y, int32 Z) { checkSlow(IndexWithinDimensions(X, Y, Z)); return (Z * DY + Y) * DX + X; }
+	static FORCEINLINE FIntVector TranslateTo3D(int32 I) { checkSlow(I >= 0 && I < Size()); return FIntVector(I % DX, (I / DX) % DY, I / (DX * DY)); }
+};
+
+/**
+ * Index math of FArray3D for dimensions only known at runtime, with the interface of TFixedArray3D.
+ * The dimensions have to be validated before, see FArray3D::ValidateDimensions.
+ */
+struct FDynamicArray3D
+{
+	explicit FDynamicArray3D(FIntVector Dimensions) : DX(Dimensions.X), DY(Dimensions.Y), DZ(Dimensions.Z) {}
+
+	const int32 DX;
+	const int32 DY;
+	const int32 DZ;
+
+	FIntVector GetDimensions() const { return FIntVector(DX, DY, DZ); }
+	int32 Size() const { return DX * DY * DZ; }
+	bool IndexWithinDimensions(int32 X, int32 Y, int32 Z) const { return X >= 0 && X < DX && Y >= 0 && Y < DY && Z >= 0 && Z < DZ; }
+
+	FORCEINLINE int32 TranslateTo1D(int32 X, int32 Y, int32 Z) const { checkSlow(IndexWithinDimensions(X, Y, Z)); return (Z * DY + Y) * DX + X; }
+	FORCEINLINE FIntVector TranslateTo3D(int32 I) const { checkSlow(I >= 0 && I < Size()); return FIntVector(I % DX, (I / DX) % DY, I / (DX * DY)); }
+};
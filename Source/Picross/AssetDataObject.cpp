@@ -35,3 +35,20 @@ FString UAssetDataObject::GetGridSizeString() const
 	FIntVector GridSize = GetGridSize();
 	return FString::Printf(TEXT("(%d, %d, %d)"), GridSize.X, GridSize.Y, GridSize.Z);
 }
+
+float UAssetDataObject::GetDifficulty() const
+{
+	float Difficulty;
+	if (AssetData.GetTagValue(TEXT("Difficulty"), Difficulty))
+	{
+		return Difficulty;
+	}
+
+	return -1.f;
+}
+
+FString UAssetDataObject::GetDifficultyString() const
+{
+	const float Difficulty = GetDifficulty();
+	return Difficulty >= 0.f ? FString::Printf(TEXT("%.0f"), Difficulty) : FString(TEXT("-"));
+}
\ No newline at end of file
@@ -24,6 +24,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Picross")
 	FString GetGridSizeString() const;
 
+	// Negative if the puzzle hasn't been rated.
+	UFUNCTION(BlueprintCallable, Category = "Picross")
+	float GetDifficulty() const;
+	UFUNCTION(BlueprintCallable, Category = "Picross")
+	FString GetDifficultyString() const;
+
 private:
 	FAssetData AssetData;
 };
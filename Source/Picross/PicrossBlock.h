@@ -13,18 +13,3 @@ enum class EBlockState : uint8
 	Crossed	UMETA(DisplayName = "Crossed"),
 	Filled	UMETA(DisplayName = "Filled")
 };
-
-USTRUCT(BlueprintType)
-struct PICROSS_API FPicrossBlock
-{
-	GENERATED_BODY()
-
-	UPROPERTY(VisibleAnywhere)
-	EBlockState State;
-	UPROPERTY(VisibleAnywhere)
-	FTransform Transform;
-	UPROPERTY(VisibleAnywhere)
-	int32 MasterIndex;
-	UPROPERTY(VisibleAnywhere)
-	int32 InstanceIndex;
-};
@@ -0,0 +1,182 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Array split into chunks of 2^ChunkShift consecutive elements, a chunk is only allocated once one of its elements differs from the default value.
+ * Every unallocated chunk shares one chunk of default values, so reading an element is the same two loads whether its chunk is allocated or not.
+ * A chunk is released again when all of its elements are back to the default and reused by the next chunk that needs one, so memory scales with the changed elements instead of Num.
+ * Chunks are runs of indices rather than 3D bricks so finding the chunk of an index is a shift instead of the divisions of FArray3D::TranslateTo3D.
+ * Every chunk has a dirty flag that is set whenever one of its elements changes, consumers clear the flags once they have caught up with the changes.
+ */
+template<typename InElementType, int32 ChunkShift = 12>
+class TPicrossChunkedArray
+{
+public:
+	typedef InElementType ElementType;
+
+	static_assert(ChunkShift > 0 && ChunkShift < 31, "ChunkShift must be between 1 and 30.");
+	static constexpr int32 ChunkSize = 1 << ChunkShift;
+
+	/**
+	 * Resizes the array to InNum elements that all read as InDefaultValue, freeing every chunk and clearing the dirty flags.
+	 */
+	void Init(const ElementType& InDefaultValue, int32 InNum)
+	{
+		DefaultValue = InDefaultValue;
+		NumElements = FMath::Max(InNum, 0);
+
+		// Rounds up without adding to NumElements, which could overflow for the largest sizes.
+		const int32 NumChunksToInit = (NumElements >> ChunkShift) + ((NumElements & ChunkMask) != 0 ? 1 : 0);
+
+		// The shared chunk of default values is always the first one in the pool.
+		Pool.Init(DefaultValue, ChunkSize);
+		FreeOffsets.Reset();
+		ChunkOffsets.Init(DefaultChunkOffset, NumChunksToInit);
+		NumChanged.Init(0, NumChunksToInit);
+		DirtyChunks.Init(false, NumChunksToInit);
+	}
+
+	int32 Num() const { return NumElements; }
+	bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumElements; }
+	const ElementType& GetDefaultValue() const { return DefaultValue; }
+
+	FORCEINLINE const ElementType& operator[](int32 Index) const
+	{
+		checkSlow(IsValidIndex(Index));
+		return Pool.GetData()[ChunkOffsets.GetData()[Index >> ChunkShift] + (Index & ChunkMask)];
+	}
+	void Set(int32 Index, const ElementType& Value)
+	{
+		checkSlow(IsValidIndex(Index));
+		const int32 ChunkIndex = Index >> ChunkShift;
+		int32 Offset = ChunkOffsets[ChunkIndex];
+		if (Offset == DefaultChunkOffset)
+		{
+			if (Value == DefaultValue) return;
+			Offset = AllocateChunk();
+			ChunkOffsets[ChunkIndex] = Offset;
+		}
+
+		ElementType& Element = Pool[Offset + (Index & ChunkMask)];
+		if (Element == Value) return;
+
+		NumChanged[ChunkIndex] += Element == DefaultValue ? 1 : Value == DefaultValue ? -1 : 0;
+		Element = Value;
+		DirtyChunks[ChunkIndex] = true;
+		if (NumChanged[ChunkIndex] == 0)
+		{
+			// Every element of the chunk is the default again, so it can be handed out as is.
+			FreeOffsets.Add(Offset);
+			ChunkOffsets[ChunkIndex] = DefaultChunkOffset;
+		}
+	}
+
+	int32 NumChunks() const { return ChunkOffsets.Num(); }
+	int32 NumAllocatedChunks() const
+	{
+		int32 Count = 0;
+		for (const int32 Offset : ChunkOffsets)
+		{
+			Count += Offset != DefaultChunkOffset ? 1 : 0;
+		}
+		return Count;
+	}
+	/**
+	 * @returns the ChunkSize elements of a chunk starting at index ChunkIndex * ChunkSize, or an empty view if every element of the chunk is the default value.
+	 * Elements past Num in the last chunk are always the default value.
+	 */
+	TArrayView<const ElementType> GetChunk(int32 ChunkIndex) const
+	{
+		const int32 Offset = ChunkOffsets[ChunkIndex];
+		return Offset != DefaultChunkOffset ? TArrayView<const ElementType>(Pool.GetData() + Offset, ChunkSize) : TArrayView<const ElementType>();
+	}
+
+	bool IsChunkDirty(int32 ChunkIndex) const { return DirtyChunks[ChunkIndex]; }
+	bool IsDirty() const { return DirtyChunks.Contains(true); }
+	void ClearDirty() { DirtyChunks.Init(false, ChunkOffsets.Num()); }
+
+	/**
+	 * Calls Func with the index and value of every element that differs from the default value in index order, skipping unallocated chunks without looking at them.
+	 */
+	template<typename FuncType>
+	void ForEachChanged(FuncType Func) const
+	{
+		for (int32 ChunkIndex = 0; ChunkIndex < ChunkOffsets.Num(); ++ChunkIndex)
+		{
+			const int32 Offset = ChunkOffsets[ChunkIndex];
+			if (Offset == DefaultChunkOffset) continue;
+
+			const ElementType* Elements = Pool.GetData() + Offset;
+			const int32 Start = ChunkIndex << ChunkShift;
+			for (int32 ElementIndex = 0; ElementIndex < ChunkSize; ++ElementIndex)
+			{
+				if (!(Elements[ElementIndex] == DefaultValue))
+				{
+					Func(Start + ElementIndex, Elements[ElementIndex]);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Writes every element in index order.
+	 */
+	void ToArray(TArray<ElementType>& OutElements) const
+	{
+		OutElements.Init(DefaultValue, NumElements);
+		for (int32 ChunkIndex = 0; ChunkIndex < ChunkOffsets.Num(); ++ChunkIndex)
+		{
+			const int32 Offset = ChunkOffsets[ChunkIndex];
+			if (Offset == DefaultChunkOffset) continue;
+
+			const int32 Start = ChunkIndex << ChunkShift;
+			for (int32 ElementIndex = 0; ElementIndex < ChunkSize && Start + ElementIndex < NumElements; ++ElementIndex)
+			{
+				OutElements[Start + ElementIndex] = Pool[Offset + ElementIndex];
+			}
+		}
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Pool.GetAllocatedSize() + FreeOffsets.GetAllocatedSize() + ChunkOffsets.GetAllocatedSize() + NumChanged.GetAllocatedSize() + DirtyChunks.GetAllocatedSize();
+	}
+
+private:
+	static constexpr int32 ChunkMask = ChunkSize - 1;
+	static constexpr int32 DefaultChunkOffset = 0;
+
+	/**
+	 * @returns the offset in Pool of a chunk whose elements are all the default value.
+	 */
+	int32 AllocateChunk()
+	{
+		if (FreeOffsets.Num() > 0)
+		{
+			return FreeOffsets.Pop(false);
+		}
+
+		// Add grows the pool with slack, reserving exactly one more chunk would copy the whole pool for every new chunk.
+		const int32 Offset = Pool.Num();
+		for (int32 ElementIndex = 0; ElementIndex < ChunkSize; ++ElementIndex)
+		{
+			Pool.Add(DefaultValue);
+		}
+		return Offset;
+	}
+
+	// The elements of every allocated chunk and of the shared default chunk, offsets into it are used instead of pointers so the array stays copyable.
+	TArray<ElementType> Pool;
+	// Offsets in Pool of the chunks that were released, their elements are all the default value.
+	TArray<int32> FreeOffsets;
+	// Where every chunk starts in Pool, DefaultChunkOffset while every element of the chunk is the default value.
+	TArray<int32> ChunkOffsets;
+	// How many elements of every chunk differ from the default value.
+	TArray<int32> NumChanged;
+	TArray<bool> DirtyChunks;
+	ElementType DefaultValue = ElementType();
+	int32 NumElements = 0;
+};
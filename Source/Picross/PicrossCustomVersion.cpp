@@ -0,0 +1,10 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+
+const FGuid FPicrossCustomVersion::GUID(0x5E1D2C47, 0x8A3F4B19, 0x9C6E0D72, 0x31F8A6B4);
+
+// Register the custom version with core.
+FCustomVersionRegistration GRegisterPicrossCustomVersion(FPicrossCustomVersion::GUID, FPicrossCustomVersion::LatestVersion, TEXT("PicrossVer"));
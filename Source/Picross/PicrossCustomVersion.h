@@ -0,0 +1,32 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/**
+ * Custom serialization version for the Picross assets.
+ */
+struct PICROSS_API FPicrossCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made.
+		BeforeCustomVersionWasAdded = 0,
+		// The puzzle solution is stored one bit per cell instead of one bool per cell.
+		PackedSolution,
+		// The clue table can be stored next to the solution, see UPicrossPuzzleData::bSerializeClues.
+		SerializedClues,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	// The GUID for this custom version number.
+	const static FGuid GUID;
+
+private:
+	FPicrossCustomVersion() {}
+};
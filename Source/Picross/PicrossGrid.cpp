@@ -3,9 +3,9 @@
 #include "PicrossGrid.h"
 #include "PicrossNumber.h"
 #include "PicrossPuzzleSaveGame.h"
-#include "Algo/Count.h"
+#include "Solver/PicrossHintEngine.h"
+#include "Solver/PicrossLineSolver.h"
 #include "Algo/ForEach.h"
-#include "Algo/Reverse.h"
 #include "AssetDataObject.h"
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/TextBlock.h"
@@ -17,6 +17,60 @@
 #include "TimerManager.h"
 
 
+namespace
+{
+	// The six blocks sharing a face with a block.
+	const FIntVector NeighbourOffsets[6] = { FIntVector(1, 0, 0), FIntVector(-1, 0, 0), FIntVector(0, 1, 0), FIntVector(0, -1, 0), FIntVector(0, 0, 1), FIntVector(0, 0, -1) };
+
+	FORCEINLINE bool IsWithinBox(const FIntVector Index, const FIntVector BoxMin, const FIntVector BoxMax)
+	{
+		return Index.X >= BoxMin.X && Index.Y >= BoxMin.Y && Index.Z >= BoxMin.Z && Index.X <= BoxMax.X && Index.Y <= BoxMax.Y && Index.Z <= BoxMax.Z;
+	}
+}
+
+void FPicrossPuzzle::SetBasis(const FVector& InOrigin, const FQuat& InRotation, const FVector& StepX, const FVector& StepY, const FVector& StepZ)
+{
+	Origin = InOrigin;
+	Rotation = InRotation;
+	Steps[0] = StepX;
+	Steps[1] = StepY;
+	Steps[2] = StepZ;
+}
+
+void FPicrossPuzzle::GetBlockTransforms(FIntVector Min, FIntVector Max, TArray<FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset((Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1));
+
+	const FVector Scale(DynamicScale);
+	for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			FVector Location = GetBlockLocation(FIntVector(Min.X, Y, Z));
+			for (int32 X = Min.X; X <= Max.X; ++X, Location += Steps[0])
+			{
+				OutTransforms.Emplace(Rotation, Location, Scale);
+			}
+		}
+	}
+}
+
+bool FPicrossPuzzle::GetBlockTransforms(TArrayView<const int32> OneDimensionalIndices, TArray<FTransform>& OutTransforms) const
+{
+	OutTransforms.Reset(OneDimensionalIndices.Num());
+
+	TArray<FIntVector> ThreeDimensionalIndices;
+	ThreeDimensionalIndices.SetNumUninitialized(OneDimensionalIndices.Num());
+	if (!FArray3D::TranslateTo3D(GridSize, OneDimensionalIndices, ThreeDimensionalIndices)) return false;
+
+	const FVector Scale(DynamicScale);
+	for (const FIntVector& ThreeDimensionalIndex : ThreeDimensionalIndices)
+	{
+		OutTransforms.Emplace(Rotation, GetBlockLocation(ThreeDimensionalIndex), Scale);
+	}
+	return true;
+}
+
 // Sets default values
 APicrossGrid::APicrossGrid()
 {
@@ -37,11 +91,26 @@ APicrossGrid::APicrossGrid()
 		}
 	}
 
-	HighlightedBlocks = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Highlight Blocks"));
+	AllBlockInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("All Blocks"));
+	if (AllBlockInstances)
+	{
+		AllBlockInstances->NumCustomDataFloats = 2; // The MasterIndex followed by the EBlockState, both stored as float.
+		AllBlockInstances->SetupAttachment(GetRootComponent());
+	}
+
+	HighlightedBlocks = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Highlight Blocks"));
 	if (HighlightedBlocks)
 	{
 		HighlightedBlocks->SetupAttachment(GetRootComponent());
 	}
+
+	HintedBlocks = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Hint Blocks"));
+	if (HintedBlocks)
+	{
+		HintedBlocks->SetupAttachment(GetRootComponent());
+	}
+
+	HintEngine = MakeShared<FPicrossHintEngine>();
 }
 
 // Called when the game starts or when spawned
@@ -49,17 +118,30 @@ void APicrossGrid::BeginPlay()
 {
 	Super::BeginPlay();
 
-	for (auto& Pair : BlockInstances)
+	if (bSingleInstanceComponent)
 	{
-		if (Pair.Value)
+		if (AllBlockInstances
+			&& ensureAlwaysMsgf(SingleBlockMesh, TEXT("Single Block Mesh missing while Single Instance Component is enabled."))
+			&& ensureAlwaysMsgf(SingleBlockMaterial, TEXT("Single Block Material missing while Single Instance Component is enabled.")))
+		{
+			AllBlockInstances->SetStaticMesh(SingleBlockMesh);
+			AllBlockInstances->SetMaterial(0, SingleBlockMaterial);
+		}
+	}
+	else
+	{
+		for (auto& Pair : BlockInstances)
 		{
-			if (ensureAlwaysMsgf(BlockMeshes.Contains(Pair.Key), TEXT("Block Meshes missing key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
-				&& ensureAlwaysMsgf(BlockMeshes.FindChecked(Pair.Key), TEXT("Block Meshes missing mesh for key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
-				&& ensureAlwaysMsgf(BlockMaterials.Contains(Pair.Key), TEXT("Block Materials missing key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
-				&& ensureAlwaysMsgf(BlockMaterials.FindChecked(Pair.Key), TEXT("Block Materials missing material for key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key)))
+			if (Pair.Value)
 			{
-				Pair.Value->SetStaticMesh(BlockMeshes[Pair.Key]);
-				Pair.Value->SetMaterial(0, BlockMaterials[Pair.Key]);
+				if (ensureAlwaysMsgf(BlockMeshes.Contains(Pair.Key), TEXT("Block Meshes missing key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
+					&& ensureAlwaysMsgf(BlockMeshes.FindChecked(Pair.Key), TEXT("Block Meshes missing mesh for key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
+					&& ensureAlwaysMsgf(BlockMaterials.Contains(Pair.Key), TEXT("Block Materials missing key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key))
+					&& ensureAlwaysMsgf(BlockMaterials.FindChecked(Pair.Key), TEXT("Block Materials missing material for key: %s"), *UEnum::GetValueAsString<EBlockState>(Pair.Key)))
+				{
+					Pair.Value->SetStaticMesh(BlockMeshes[Pair.Key]);
+					Pair.Value->SetMaterial(0, BlockMaterials[Pair.Key]);
+				}
 			}
 		}
 	}
@@ -70,10 +152,18 @@ void APicrossGrid::BeginPlay()
 		HighlightedBlocks->SetStaticMesh(HighlightMesh);
 		HighlightedBlocks->SetMaterial(0, HighlightMaterial);
 	}
+
+	if (HintedBlocks && HighlightMesh && HintMaterial)
+	{
+		HintedBlocks->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		HintedBlocks->SetStaticMesh(HighlightMesh);
+		HintedBlocks->SetMaterial(0, HintMaterial);
+	}
 }
 
 void APicrossGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	HintEngine->Cancel();
 	SaveGame();
 }
 
@@ -87,8 +177,15 @@ void APicrossGrid::CreateGrid()
 	RedoStack.Empty();
 	SelectionAxis = EAxis::None;
 	FocusedBlock = FIntVector::ZeroValue;
-	SolutionFilledBlocksCount = Algo::Count(Puzzle.GetPuzzleData()->GetSolution(), true);
+	SolutionFilledBlocksCount = Puzzle.GetPuzzleData()->GetSolution().CountFilled();
 	CurrentlyFilledBlocksCount = 0;
+	FilledBlocks.Init(Puzzle.Num());
+	ClearHint();
+	HintEngine->SetPuzzle(*Puzzle.GetPuzzleData());
+
+	// Starts over with every block clear, without dirtying any chunk, so the next save has to write every chunk again.
+	Puzzle = FPicrossPuzzle(Puzzle.GetPuzzleData());
+	CurrentSaveGame = nullptr;
 
 	const int32 MaxAxis = Puzzle.GetGridSize().GetMax();
 	const float TargetSize = 10.f;
@@ -101,29 +198,15 @@ void APicrossGrid::CreateGrid()
 	StartPosition -= GetActorRightVector() * (DynamicDistanceBetweenBlocks * (Puzzle.Y() / 2) - (Puzzle.Y() % 2 == 0 ? DynamicDistanceBetweenBlocks / 2 : 0));
 	StartPosition -= GetActorForwardVector() * (DynamicDistanceBetweenBlocks * (Puzzle.X() / 2) - (Puzzle.X() % 2 == 0 ? DynamicDistanceBetweenBlocks / 2 : 0));
 
-	for (int32 Z = 0; Z < Puzzle.Z(); ++Z)
-	{
-		const float OffsetZ = DynamicDistanceBetweenBlocks * Z;
-		for (int32 Y = 0; Y < Puzzle.Y(); ++Y)
-		{
-			const float OffsetY = DynamicDistanceBetweenBlocks * Y;
-			for (int32 X = 0; X < Puzzle.X(); ++X)
-			{
-				const float OffsetX = DynamicDistanceBetweenBlocks * X;
-				FVector BlockPosition = StartPosition;
-				BlockPosition += GetActorForwardVector() * OffsetX;
-				BlockPosition += GetActorRightVector() * OffsetY;
-				BlockPosition += GetActorUpVector() * OffsetZ;
-
-				const int32 MasterIndex = Puzzle.GetIndex(FIntVector(X,Y,Z));
-				FPicrossBlock& Block = Puzzle[MasterIndex] = FPicrossBlock{ EBlockState::Clear, FTransform(GetActorRotation(), BlockPosition, DynamicScale), MasterIndex, INDEX_NONE };
-				CreateBlockInstance(Block);
-			}
-		}
-	}
+	Puzzle.SetBasis(StartPosition, GetActorQuat(), GetActorForwardVector() * DynamicDistanceBetweenBlocks, GetActorRightVector() * DynamicDistanceBetweenBlocks, GetActorUpVector() * DynamicDistanceBetweenBlocks);
+	ShownMin = FIntVector::ZeroValue;
+	ShownMax = Puzzle.GetGridSize() - FIntVector(1);
+	CreateBlockInstances(FIntVector::ZeroValue, Puzzle.GetGridSize() - FIntVector(1));
 
 	GenerateNumbers();
+	bHighlightsOutdated = true;
 	HighlightBlocks();
+	RestartHint();
 }
 
 void APicrossGrid::ClearGrid()
@@ -132,11 +215,20 @@ void APicrossGrid::ClearGrid()
 
 	DisableAllBlocks();
 
-	for (FPicrossBlock& Block : Puzzle)
+	TArray<int32> ChangedBlocks;
+	Puzzle.GetStates().ForEachChanged([&ChangedBlocks](int32 MasterIndex, EBlockState State)
+	{
+		ChangedBlocks.Add(MasterIndex);
+	});
+	for (const int32 MasterIndex : ChangedBlocks)
 	{
-		Block.State = EBlockState::Clear;
-		CreateBlockInstance(Block);
+		Puzzle.SetState(MasterIndex, EBlockState::Clear);
 	}
+	CreateBlockInstances(FIntVector::ZeroValue, Puzzle.GetGridSize() - FIntVector(1));
+	CurrentlyFilledBlocksCount = 0;
+	FilledBlocks.Init(Puzzle.Num());
+
+	HandleBlocksChanged(ChangedBlocks);
 }
 
 void APicrossGrid::DestroyGrid()
@@ -148,54 +240,80 @@ void APicrossGrid::DestroyGrid()
 			ISM.Value->ClearInstances();
 		}
 	}
+
+	if (AllBlockInstances)
+	{
+		AllBlockInstances->ClearInstances();
+	}
 }
 
 void APicrossGrid::UpdateBlocks(const int32 StartMasterIndex, const int32 EndMasterIndex, const EBlockState Action)
 {
 	if (StartMasterIndex == INDEX_NONE || EndMasterIndex == INDEX_NONE) return;
 
-	const EBlockState PreviousState = Puzzle[StartMasterIndex].State;
+	const EBlockState PreviousState = Puzzle.GetState(StartMasterIndex);
 	const EBlockState NewState = Action == EBlockState::Filled ? (PreviousState != EBlockState::Filled ? EBlockState::Filled : EBlockState::Clear) : (PreviousState != EBlockState::Crossed ? EBlockState::Crossed : EBlockState::Clear);
 	UpdateBlocks(StartMasterIndex, EndMasterIndex, PreviousState, NewState);
 }
 
 void APicrossGrid::UpdateBlocks(const int32 StartMasterIndex, const int32 EndMasterIndex, const EBlockState PreviousState, const EBlockState NewState)
 {
+	if (IsLocked()) return;
 	if (StartMasterIndex == INDEX_NONE || EndMasterIndex == INDEX_NONE) return;
 
-	FPicrossAction Action;
-	const FIntVector StartIndex = Puzzle.GetIndex(StartMasterIndex);
-	const FIntVector EndIndex = Puzzle.GetIndex(EndMasterIndex);
+	if (!Puzzle.IsValidIndex(StartMasterIndex) || !Puzzle.IsValidIndex(EndMasterIndex)) return;
 
-	for (int32 Z = (StartIndex.Z < EndIndex.Z ? StartIndex.Z : EndIndex.Z); Z <= (StartIndex.Z < EndIndex.Z ? EndIndex.Z : StartIndex.Z); ++Z)
+	FPicrossAction Action;
+	TArray<int32> ChangedBlocks;
+	TArray<TPair<int32, EBlockState>> Changes;
+	const FIntVector StartIndex = Puzzle.GetIndexUnchecked(StartMasterIndex);
+	const FIntVector EndIndex = Puzzle.GetIndexUnchecked(EndMasterIndex);
+	const FIntVector Min(FMath::Min(StartIndex.X, EndIndex.X), FMath::Min(StartIndex.Y, EndIndex.Y), FMath::Min(StartIndex.Z, EndIndex.Z));
+	const FIntVector Max(FMath::Max(StartIndex.X, EndIndex.X), FMath::Max(StartIndex.Y, EndIndex.Y), FMath::Max(StartIndex.Z, EndIndex.Z));
+
+	// Both corners are inside the grid so the whole box is, which is what makes the unchecked indexing safe.
+	for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
 	{
-		for (int32 Y = (StartIndex.Y < EndIndex.Y ? StartIndex.Y : EndIndex.Y); Y <= (StartIndex.Y < EndIndex.Y ? EndIndex.Y : StartIndex.Y); ++Y)
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
 		{
-			for (int32 X = (StartIndex.X < EndIndex.X ? StartIndex.X : EndIndex.X); X <= (StartIndex.X < EndIndex.X ? EndIndex.X : StartIndex.X); ++X)
+			const int32 RowStart = Puzzle.GetIndexUnchecked(0, Y, Z);
+			for (int32 X = Min.X; X <= Max.X; ++X)
 			{
-				const FIntVector Index = FIntVector(X, Y, Z);
-				if (Puzzle[Index].State == PreviousState)
+				const int32 MasterIndex = RowStart + X;
+				if (Puzzle.GetStateUnchecked(MasterIndex) == PreviousState)
 				{
-					UpdateBlockState(Puzzle[Index], NewState);
-					Action.Actions.Add(FPicrossBlockAction{ Index, PreviousState, NewState });
+					Changes.Emplace(MasterIndex, NewState);
+					Action.Actions.Add(FPicrossBlockAction{ FIntVector(X, Y, Z), PreviousState, NewState });
+					ChangedBlocks.Add(MasterIndex);
 				}
 			}
 		}
 	}
-	
+	// An empty action would take an undo step that does nothing and throw away the redo history.
+	if (Changes.Num() == 0) return;
+
+	UpdateBlockStates(Changes);
+
 	UndoStack.Push(MoveTemp(Action));
 	RedoStack.Empty();
+	HandleBlocksChanged(ChangedBlocks);
 }
 
 void APicrossGrid::Undo()
 {
 	if (!IsLocked() && UndoStack.Num() > 0)
 	{
+		TArray<int32> ChangedBlocks;
+		TArray<TPair<int32, EBlockState>> Changes;
 		for (const FPicrossBlockAction& Action : UndoStack.Top().Actions)
 		{
-			UpdateBlockState(Puzzle[Action.BlockIndex], Action.PreviousState);
+			const int32 MasterIndex = Puzzle.GetIndexUnchecked(Action.BlockIndex);
+			Changes.Emplace(MasterIndex, Action.PreviousState);
+			ChangedBlocks.Add(MasterIndex);
 		}
+		UpdateBlockStates(Changes);
 		RedoStack.Push(UndoStack.Pop());
+		HandleBlocksChanged(ChangedBlocks);
 	}
 }
 
@@ -203,45 +321,65 @@ void APicrossGrid::Redo()
 {
 	if (!IsLocked() && RedoStack.Num() > 0)
 	{
+		TArray<int32> ChangedBlocks;
+		TArray<TPair<int32, EBlockState>> Changes;
 		for (const FPicrossBlockAction& Action : RedoStack.Top().Actions)
 		{
-			UpdateBlockState(Puzzle[Action.BlockIndex], Action.NewState);
+			const int32 MasterIndex = Puzzle.GetIndexUnchecked(Action.BlockIndex);
+			Changes.Emplace(MasterIndex, Action.NewState);
+			ChangedBlocks.Add(MasterIndex);
 		}
+		UpdateBlockStates(Changes);
 		UndoStack.Push(RedoStack.Pop());
+		HandleBlocksChanged(ChangedBlocks);
 	}
 }
 
 void APicrossGrid::HighlightBlocks()
 {
-	HighlightedBlocks->ClearInstances();
+	// A line through the focused block along every axis except the one of the 2D selection, and none while locked.
+	uint8 Axes = 0;
+	if (!IsLocked())
+	{
+		switch (SelectionAxis)
+		{
+			case EAxis::X:		Axes = 0b110;	break;
+			case EAxis::Y:		Axes = 0b101;	break;
+			case EAxis::Z:		Axes = 0b011;	break;
+			case EAxis::None:	Axes = 0b111;	break;
+			default:							break;
+		}
+	}
 
-	if (IsLocked()) return;
+	if (!bHighlightsOutdated && Axes == HighlightedAxes && FocusedBlock == HighlightedFocus) return;
 
-	switch (SelectionAxis)
+	bHighlightsOutdated = false;
+	HighlightedAxes = Axes;
+	HighlightedFocus = FocusedBlock;
+
+	// The pool has an instance for every block of the three lines, the lines that aren't highlighted are scaled to zero.
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(Puzzle.X() + Puzzle.Y() + Puzzle.Z());
+	GetHighlightTransforms(EAxis::X, (Axes & 0b001) != 0, Transforms);
+	GetHighlightTransforms(EAxis::Y, (Axes & 0b010) != 0, Transforms);
+	GetHighlightTransforms(EAxis::Z, (Axes & 0b100) != 0, Transforms);
+
+	if (HighlightedBlocks->GetInstanceCount() == Transforms.Num())
 	{
-		case EAxis::X:
-			HighlightBlocksInAxis(EAxis::Y);
-			HighlightBlocksInAxis(EAxis::Z);
-			break;
-		case EAxis::Y:
-			HighlightBlocksInAxis(EAxis::X);
-			HighlightBlocksInAxis(EAxis::Z);
-			break;
-		case EAxis::Z:
-			HighlightBlocksInAxis(EAxis::X);
-			HighlightBlocksInAxis(EAxis::Y);
-			break;
-		case EAxis::None:
-			HighlightBlocksInAxis(EAxis::X);
-			HighlightBlocksInAxis(EAxis::Y);
-			HighlightBlocksInAxis(EAxis::Z);
-			break;
-		default:
-			break;
+		HighlightedBlocks->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+	else
+	{
+		// Only when the size of the grid changes.
+		HighlightedBlocks->ClearInstances();
+		for (const FTransform& Transform : Transforms)
+		{
+			HighlightedBlocks->AddInstanceWorldSpace(Transform);
+		}
 	}
 }
 
-void APicrossGrid::HighlightBlocksInAxis(const EAxis::Type AxisToHighlight)
+void APicrossGrid::GetHighlightTransforms(const EAxis::Type AxisToHighlight, const bool bShown, TArray<FTransform>& OutTransforms) const
 {
 	const FIntVector XYZ = FocusedBlock;
 	const int32 EndIndex = (AxisToHighlight == EAxis::X ? Puzzle.X() : AxisToHighlight == EAxis::Y ? Puzzle.Y() : Puzzle.Z());
@@ -249,125 +387,501 @@ void APicrossGrid::HighlightBlocksInAxis(const EAxis::Type AxisToHighlight)
 	for (int32 AxisIndex = 0; AxisIndex < EndIndex; ++AxisIndex)
 	{
 		const FIntVector MasterIndex = FIntVector(AxisToHighlight == EAxis::X ? AxisIndex : XYZ.X, AxisToHighlight == EAxis::Y ? AxisIndex : XYZ.Y, AxisToHighlight == EAxis::Z ? AxisIndex : XYZ.Z);
-		FTransform HighlightBlockTransform = Puzzle[MasterIndex].Transform;
+		const FTransform BlockTransform = Puzzle.GetBlockTransform(MasterIndex);
+		FTransform HighlightBlockTransform = BlockTransform;
 		HighlightBlockTransform.SetScale3D(HighlightBlockTransform.GetScale3D() * 1.05f);
-		HighlightBlockTransform.AddToTranslation((-GetActorUpVector()) * 100.f * ((HighlightBlockTransform.GetScale3D().Z - Puzzle[MasterIndex].Transform.GetScale3D().Z) / 2));
-		HighlightedBlocks->AddInstanceWorldSpace(HighlightBlockTransform);
+		HighlightBlockTransform.AddToTranslation((-GetActorUpVector()) * 100.f * ((HighlightBlockTransform.GetScale3D().Z - BlockTransform.GetScale3D().Z) / 2));
+		if (!bShown)
+		{
+			HighlightBlockTransform.SetScale3D(FVector::ZeroVector);
+		}
+		OutTransforms.Add(HighlightBlockTransform);
 	}
 }
 
+void APicrossGrid::HandleBlocksChanged(TArrayView<const int32> ChangedBlocks)
+{
+	RestartHint();
+}
+
+void APicrossGrid::SetHintsEnabled(bool bEnabled)
+{
+	if (bHintsEnabled != bEnabled)
+	{
+		bHintsEnabled = bEnabled;
+		RestartHint();
+	}
+}
+
+void APicrossGrid::RestartHint()
+{
+	ClearHint();
+	HintEngine->Cancel();
+
+	if (!bHintsEnabled || IsLocked() || !Puzzle.IsValid()) return;
+
+	// Only the touched chunks are copied here, the search unpacks them on its own thread.
+	TPicrossChunkedArray<EBlockState> States = Puzzle.GetStates();
+	HintEngine->Request(MoveTemp(States), FPicrossHintEngine::FOnHintFound::CreateUObject(this, &APicrossGrid::ShowHint));
+}
+
+void APicrossGrid::ClearHint()
+{
+	if (HintedBlocks)
+	{
+		HintedBlocks->ClearInstances();
+	}
+}
+
+void APicrossGrid::ShowHint(const FPicrossHint& Hint)
+{
+	ClearHint();
+
+	if (IsLocked() || !HintedBlocks) return;
+
+	for (const FPicrossHintCell& Cell : Hint.Cells)
+	{
+		if (!Puzzle.IsValidIndex(Cell.MasterIndex)) continue;
+
+		const FTransform BlockTransform = Puzzle.GetBlockTransform(Cell.MasterIndex);
+		FTransform HintBlockTransform = BlockTransform;
+		HintBlockTransform.SetScale3D(HintBlockTransform.GetScale3D() * 1.1f);
+		HintBlockTransform.AddToTranslation((-GetActorUpVector()) * 100.f * ((HintBlockTransform.GetScale3D().Z - BlockTransform.GetScale3D().Z) / 2));
+		HintedBlocks->AddInstanceWorldSpace(HintBlockTransform);
+	}
+
+	HintFound.Broadcast();
+}
+
 void APicrossGrid::EnableOnlyFilledBlocks()
 {
 	if (IsLocked()) return;
 
 	DisableAllBlocks();
+	ShownMin = FIntVector::ZeroValue;
+	ShownMax = Puzzle.GetGridSize() - FIntVector(1);
 
-	for (FPicrossBlock& Block : Puzzle)
+	TArray<int32> FilledIndices;
+	Puzzle.GetStates().ForEachChanged([&FilledIndices](int32 MasterIndex, EBlockState State)
 	{
-		if (Block.State == EBlockState::Filled)
+		if (State == EBlockState::Filled)
 		{
-			CreateBlockInstance(Block);
+			FilledIndices.Add(MasterIndex);
 		}
+	});
+
+	TArray<FTransform> Transforms;
+	if (!Puzzle.GetBlockTransforms(FilledIndices, Transforms)) return;
+
+	for (int32 Index = 0; Index < Transforms.Num(); ++Index)
+	{
+		CreateBlockInstance(FilledIndices[Index], Transforms[Index]);
 	}
 }
 
-void APicrossGrid::UpdateBlockState(FPicrossBlock& Block, const EBlockState NewState)
+void APicrossGrid::UpdateBlockStates(TArrayView<const TPair<int32, EBlockState>> Changes)
 {
 	if (IsLocked()) return;
 
-	if (Block.State != NewState && Block.InstanceIndex != INDEX_NONE)
+	// The instances leaving and the blocks joining every component.
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> RemovedInstances;
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> AddedBlocks;
+	TArray<int32> ChangedBlocks;
+	bool bSingleInstancesChanged = false;
+	for (const TPair<int32, EBlockState>& Change : Changes)
+	{
+		const int32 MasterIndex = Change.Key;
+		const EBlockState PreviousState = Puzzle.GetState(MasterIndex);
+		const EBlockState NewState = Change.Value;
+		const int32 InstanceIndex = Puzzle.GetInstanceIndex(MasterIndex);
+		// Enclosed blocks have no instance while culling but still change state.
+		if (PreviousState == NewState || (InstanceIndex == INDEX_NONE && !bCullEnclosedBlocks)) continue;
+
+		if (InstanceIndex != INDEX_NONE)
+		{
+			if (bSingleInstanceComponent)
+			{
+				// The instance stays where it is, only the state the material switches on changes.
+				AllBlockInstances->SetCustomDataValue(InstanceIndex, StateCustomDataIndex, static_cast<float>(NewState), false);
+				bSingleInstancesChanged = true;
+			}
+			else
+			{
+				RemovedInstances.FindOrAdd(BlockInstances[PreviousState]).Add(InstanceIndex);
+				Puzzle.SetInstanceIndex(MasterIndex, INDEX_NONE);
+				// While culling the block is added back below, if it's still exposed.
+				if (!bCullEnclosedBlocks)
+				{
+					AddedBlocks.FindOrAdd(BlockInstances[NewState]).Add(MasterIndex);
+				}
+			}
+		}
+		Puzzle.SetState(MasterIndex, NewState);
+		ChangedBlocks.Add(MasterIndex);
+
+		CurrentlyFilledBlocksCount += PreviousState == EBlockState::Filled ? -1 : NewState == EBlockState::Filled ? 1 : 0;
+		FilledBlocks.Set(MasterIndex, NewState == EBlockState::Filled);
+	}
+
+	if (bSingleInstancesChanged)
+	{
+		AllBlockInstances->MarkRenderStateDirty();
+	}
+
+	if (bCullEnclosedBlocks)
 	{
-		const EBlockState PreviousState = Block.State;
-		const int32 PreviousInstanceIndex = Block.InstanceIndex;
-		BlockInstances[PreviousState]->RemoveInstance(PreviousInstanceIndex);
+		CullEnclosedBlocks(ChangedBlocks, RemovedInstances, AddedBlocks);
+	}
+	UpdateBlockInstances(RemovedInstances, AddedBlocks);
 
-		// Side effect of removing a instance in a HISM is that it swaps with another block before removing. That other block then has an outdated InstanceIndex saved, we update that here.
-		const int32 PreviousInstanceCustomDataIndex = PreviousInstanceIndex * BlockInstances[PreviousState]->NumCustomDataFloats;
-		if (BlockInstances[PreviousState]->PerInstanceSMCustomData.IsValidIndex(PreviousInstanceCustomDataIndex))
+	TrySolve();
+}
+
+void APicrossGrid::UpdateBlockInstances(const TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, const TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks)
+{
+	// Every removal and addition would otherwise rebuild the cluster tree of its component, it's rebuilt once per component at the end instead.
+	TArray<UHierarchicalInstancedStaticMeshComponent*> ChangedComponents;
+	for (const TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>* Map : { &RemovedInstances, &AddedBlocks })
+	{
+		for (const TPair<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& Pair : *Map)
 		{
-			const int32 SwappedBlockMasterIndex = static_cast<int32>(BlockInstances[PreviousState]->PerInstanceSMCustomData[PreviousInstanceCustomDataIndex]);
-			Puzzle[SwappedBlockMasterIndex].InstanceIndex = PreviousInstanceIndex;
+			if (!ChangedComponents.Contains(Pair.Key))
+			{
+				Pair.Key->bAutoRebuildTreeOnInstanceChanges = false;
+				ChangedComponents.Add(Pair.Key);
+			}
 		}
+	}
 
-		Block.State = NewState;
-		CreateBlockInstance(Block);
+	for (const TPair<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& Pair : RemovedInstances)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Instances = Pair.Key;
+		Instances->RemoveInstances(Pair.Value);
 
-		CurrentlyFilledBlocksCount += PreviousState == EBlockState::Filled ? -1 : NewState == EBlockState::Filled ? 1 : 0;
-		TrySolve();
+		// Removing an instance moves the last one into its place, and RemoveInstances goes from the highest index down so no instance that's still to be removed moves.
+		// Afterwards the only instances that moved are the ones sitting in a removed slot, their blocks get the new InstanceIndex here.
+		const int32 NumInstances = Instances->GetInstanceCount();
+		for (const int32 InstanceIndex : Pair.Value)
+		{
+			if (InstanceIndex < NumInstances)
+			{
+				const int32 MovedBlockMasterIndex = static_cast<int32>(Instances->PerInstanceSMCustomData[InstanceIndex * Instances->NumCustomDataFloats + MasterIndexCustomDataIndex]);
+				Puzzle.SetInstanceIndex(MovedBlockMasterIndex, InstanceIndex);
+			}
+		}
+	}
+
+	for (const TPair<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& Pair : AddedBlocks)
+	{
+		UHierarchicalInstancedStaticMeshComponent* Instances = Pair.Key;
+
+		// AddInstances takes transforms relative to the component, same as AddInstanceWorldSpace converts them to.
+		TArray<FTransform> Transforms;
+		if (!Puzzle.GetBlockTransforms(Pair.Value, Transforms)) continue;
+
+		const FTransform ComponentTransform = Instances->GetComponentTransform();
+		for (int32 Index = 0; Index < Transforms.Num(); ++Index)
+		{
+			if (!IsBlockShown(Pair.Value[Index]))
+			{
+				Transforms[Index].SetScale3D(FVector::ZeroVector);
+			}
+			Transforms[Index] = Transforms[Index].GetRelativeTransform(ComponentTransform);
+		}
+
+		const TArray<int32> InstanceIndices = Instances->AddInstances(Transforms, true);
+		for (int32 Index = 0; Index < InstanceIndices.Num(); ++Index)
+		{
+			const int32 MasterIndex = Pair.Value[Index];
+			checkSlow(MasterIndex < FPicrossPuzzle::MaxNum);
+			Instances->SetCustomDataValue(InstanceIndices[Index], MasterIndexCustomDataIndex, static_cast<float>(MasterIndex), false);
+			if (bSingleInstanceComponent)
+			{
+				Instances->SetCustomDataValue(InstanceIndices[Index], StateCustomDataIndex, static_cast<float>(Puzzle.GetState(MasterIndex)), false);
+			}
+			Puzzle.SetInstanceIndex(MasterIndex, InstanceIndices[Index]);
+		}
+	}
+
+	for (UHierarchicalInstancedStaticMeshComponent* Instances : ChangedComponents)
+	{
+		Instances->bAutoRebuildTreeOnInstanceChanges = true;
+		Instances->BuildTreeIfOutdated(true, false);
+		Instances->MarkRenderStateDirty();
 	}
 }
 
-void APicrossGrid::CreateBlockInstance(FPicrossBlock& Block) const
+bool APicrossGrid::IsBlockExposed(const FIntVector Index) const
 {
-	const int32 InstanceIndex = BlockInstances[Block.State]->AddInstanceWorldSpace(Block.Transform);
-	BlockInstances[Block.State]->SetCustomDataValue(InstanceIndex, 0, static_cast<float>(Block.MasterIndex));
-	Block.InstanceIndex = InstanceIndex;
+	if (!IsBlockShown(Index)) return false;
+
+	for (const FIntVector& Offset : NeighbourOffsets)
+	{
+		const FIntVector Neighbour = Index + Offset;
+		if (!Puzzle.IsValidIndex(Neighbour) || !IsBlockShown(Neighbour) || Puzzle.GetState(Puzzle.GetIndexUnchecked(Neighbour)) == EBlockState::Crossed)
+		{
+			return true;
+		}
+	}
+	return false;
 }
 
-void APicrossGrid::GenerateNumbers()
+void APicrossGrid::CullEnclosedBlocks(TArrayView<const int32> ChangedBlocks, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks)
 {
-	CleanupNumbers();
+	// A block is only exposed through its neighbours, so only the changed blocks and the six neighbours of each can change.
+	TSet<int32> AffectedBlocks;
+	AffectedBlocks.Reserve(ChangedBlocks.Num() * 7);
+	for (const int32 MasterIndex : ChangedBlocks)
+	{
+		const FIntVector Index = Puzzle.GetIndexUnchecked(MasterIndex);
+		AffectedBlocks.Add(MasterIndex);
+		for (const FIntVector& Offset : NeighbourOffsets)
+		{
+			if (Puzzle.IsValidIndex(Index + Offset))
+			{
+				AffectedBlocks.Add(Puzzle.GetIndexUnchecked(Index + Offset));
+			}
+		}
+	}
 
-	if (IsLocked()) return;
+	for (const int32 MasterIndex : AffectedBlocks)
+	{
+		UpdateBlockExposure(MasterIndex, RemovedInstances, AddedBlocks);
+	}
+}
 
-	GenerateNumbersForAxis(EAxis::X);
-	GenerateNumbersForAxis(EAxis::Y);
-	GenerateNumbersForAxis(EAxis::Z);
+void APicrossGrid::UpdateBlockExposure(const int32 MasterIndex, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks)
+{
+	const bool bExposed = IsBlockExposed(Puzzle.GetIndexUnchecked(MasterIndex));
+	const int32 InstanceIndex = Puzzle.GetInstanceIndex(MasterIndex);
+	if (bExposed && InstanceIndex == INDEX_NONE)
+	{
+		AddedBlocks.FindOrAdd(GetBlockInstances(MasterIndex)).Add(MasterIndex);
+	}
+	else if (!bExposed && InstanceIndex != INDEX_NONE)
+	{
+		RemovedInstances.FindOrAdd(GetBlockInstances(MasterIndex)).Add(InstanceIndex);
+		Puzzle.SetInstanceIndex(MasterIndex, INDEX_NONE);
+	}
 }
 
-void APicrossGrid::GenerateNumbersForAxis(EAxis::Type Axis)
+void APicrossGrid::CreateBlockInstance(const int32 MasterIndex)
+{
+	CreateBlockInstance(MasterIndex, Puzzle.GetBlockTransform(MasterIndex));
+}
+
+void APicrossGrid::CreateBlockInstance(const int32 MasterIndex, const FTransform& Transform)
+{
+	const EBlockState State = Puzzle.GetState(MasterIndex);
+	UHierarchicalInstancedStaticMeshComponent* Instances = GetBlockInstances(MasterIndex);
+	FTransform InstanceTransform = Transform;
+	if (!IsBlockShown(MasterIndex))
+	{
+		InstanceTransform.SetScale3D(FVector::ZeroVector);
+	}
+	const int32 InstanceIndex = Instances->AddInstanceWorldSpace(InstanceTransform);
+	checkSlow(MasterIndex < FPicrossPuzzle::MaxNum);
+	Instances->SetCustomDataValue(InstanceIndex, MasterIndexCustomDataIndex, static_cast<float>(MasterIndex));
+	if (bSingleInstanceComponent)
+	{
+		Instances->SetCustomDataValue(InstanceIndex, StateCustomDataIndex, static_cast<float>(State));
+	}
+	Puzzle.SetInstanceIndex(MasterIndex, InstanceIndex);
+}
+
+UHierarchicalInstancedStaticMeshComponent* APicrossGrid::GetBlockInstances(const int32 MasterIndex) const
+{
+	return bSingleInstanceComponent ? AllBlockInstances : BlockInstances.FindChecked(Puzzle.GetState(MasterIndex));
+}
+
+bool APicrossGrid::IsBlockShown(const int32 MasterIndex) const
+{
+	return IsBlockShown(Puzzle.GetIndexUnchecked(MasterIndex));
+}
+
+bool APicrossGrid::IsBlockShown(const FIntVector Index) const
+{
+	return IsWithinBox(Index, ShownMin, ShownMax);
+}
+
+void APicrossGrid::ShowBlocks(const FIntVector Min, const FIntVector Max)
 {
 	if (!Puzzle.IsValid()) return;
+	if (!ensureAlwaysMsgf(Puzzle.IsValidIndex(Min) && Puzzle.IsValidIndex(Max), TEXT("Tried to show blocks outside of the grid."))) return;
+	if (Min == ShownMin && Max == ShownMax) return;
 
-	const TArray<bool>& Solution = Puzzle.GetPuzzleData()->GetSolution();
+	const FIntVector PreviousMin = ShownMin;
+	const FIntVector PreviousMax = ShownMax;
+	ShownMin = Min;
+	ShownMax = Max;
 
-	if (Solution.Num() != FArray3D::Size(Puzzle.GetGridSize())) return;
+	if (bCullEnclosedBlocks)
+	{
+		CullShownBlocks(PreviousMin, PreviousMax);
+		return;
+	}
 
-	// Axis1 is Y-axis if we're generating for X-axis, otherwise it's the X-axis.
-	int32 Axis1Size = (Axis == EAxis::X ? Puzzle.Y() : Puzzle.X());
-	for (int32 Axis1 = 0; Axis1 < Axis1Size; ++Axis1)
+	// Only the blocks leaving or entering the box get a new transform, and every changed component rebuilds its tree once at the end.
+	TArray<UHierarchicalInstancedStaticMeshComponent*> ChangedComponents;
+	const auto UpdateInstances = [this, &ChangedComponents](const FIntVector BoxMin, const FIntVector BoxMax, const FIntVector OtherMin, const FIntVector OtherMax, const bool bShown)
 	{
-		// Axis2 is Y-axis if we're generating for Z-Axis, otherwise it's the Z-axis.
-		int32 Axis2Size = (Axis == EAxis::Z ? Puzzle.Y() : Puzzle.Z());
-		for (int32 Axis2 = 0; Axis2 < Axis2Size; ++Axis2)
+		for (int32 Z = BoxMin.Z; Z <= BoxMax.Z; ++Z)
 		{
-			FFormatOrderedArguments Numbers;
-			int32 Sum = 0;
-
-			// Axis3 is the axis we're generating numbers for.
-			int32 Axis3Size = (Axis == EAxis::Z ? Puzzle.Z() : Axis == EAxis::X ? Puzzle.X() : Puzzle.Y());
-			for (int32 Axis3 = 0; Axis3 < Axis3Size; ++Axis3)
+			for (int32 Y = BoxMin.Y; Y <= BoxMax.Y; ++Y)
 			{
-				// De-anonymize Axis1,Axis2,Axis3 into their named version (X,Y,Z)
-				FIntVector XYZ = Axis == EAxis::X ? FIntVector(Axis3, Axis1, Axis2) : Axis == EAxis::Y ? FIntVector(Axis1, Axis3, Axis2) : FIntVector(Axis1, Axis2, Axis3);
-
-				// Count the filled blocks, adding the results to the Numbers "array".
-				bool bCountBlock = Solution[Puzzle.GetIndex(XYZ)];
-				if (bCountBlock)
+				const int32 RowStart = Puzzle.GetIndexUnchecked(0, Y, Z);
+				for (int32 X = BoxMin.X; X <= BoxMax.X; ++X)
 				{
-					++Sum;
+					// Blocks that are in both boxes keep their visibility.
+					if (IsWithinBox(FIntVector(X, Y, Z), OtherMin, OtherMax)) continue;
+
+					const int32 MasterIndex = RowStart + X;
+					const int32 InstanceIndex = Puzzle.GetInstanceIndex(MasterIndex);
+					if (InstanceIndex == INDEX_NONE) continue;
+
+					UHierarchicalInstancedStaticMeshComponent* Instances = GetBlockInstances(MasterIndex);
+					if (!ChangedComponents.Contains(Instances))
+					{
+						Instances->bAutoRebuildTreeOnInstanceChanges = false;
+						ChangedComponents.Add(Instances);
+					}
+
+					FTransform Transform = Puzzle.GetBlockTransform(FIntVector(X, Y, Z));
+					if (!bShown)
+					{
+						Transform.SetScale3D(FVector::ZeroVector);
+					}
+					Instances->UpdateInstanceTransform(InstanceIndex, Transform, true, false, true);
+				}
+			}
+		}
+	};
+	UpdateInstances(PreviousMin, PreviousMax, Min, Max, false);
+	UpdateInstances(Min, Max, PreviousMin, PreviousMax, true);
+
+	for (UHierarchicalInstancedStaticMeshComponent* Instances : ChangedComponents)
+	{
+		Instances->bAutoRebuildTreeOnInstanceChanges = true;
+		Instances->BuildTreeIfOutdated(true, false);
+		Instances->MarkRenderStateDirty();
+	}
+}
 
-					if (Sum > 0 && Axis3 == Axis3Size - 1)
+void APicrossGrid::CullShownBlocks(const FIntVector PreviousMin, const FIntVector PreviousMax)
+{
+	// Hidden blocks have no instance, so a block only needs one added or removed if it changed visibility and is exposed on one side of the change, or if a neighbour changed visibility.
+	// Exposed blocks are on the surface of their box or next to a crossed block, and blocks staying shown next to a change are on the surface of the overlap of both boxes.
+	TSet<int32> CandidateBlocks;
+	const auto AddBoxSurface = [this, &CandidateBlocks](const FIntVector BoxMin, const FIntVector BoxMax)
+	{
+		for (int32 Z = BoxMin.Z; Z <= BoxMax.Z; ++Z)
+		{
+			for (int32 Y = BoxMin.Y; Y <= BoxMax.Y; ++Y)
+			{
+				const int32 RowStart = Puzzle.GetIndexUnchecked(0, Y, Z);
+				if (Z == BoxMin.Z || Z == BoxMax.Z || Y == BoxMin.Y || Y == BoxMax.Y)
+				{
+					for (int32 X = BoxMin.X; X <= BoxMax.X; ++X)
 					{
-						Numbers.Add(Sum);
+						CandidateBlocks.Add(RowStart + X);
 					}
 				}
-				else if (Sum > 0)
+				else
 				{
-					Numbers.Add(Sum);
-					Sum = 0;
+					CandidateBlocks.Add(RowStart + BoxMin.X);
+					CandidateBlocks.Add(RowStart + BoxMax.X);
 				}
 			}
-			
-			// Reverse Numbers if Axis is Z since we counted them from opposite side.
-			if (Axis == EAxis::Z) Algo::Reverse(Numbers);
+		}
+	};
+	AddBoxSurface(PreviousMin, PreviousMax);
+	AddBoxSurface(ShownMin, ShownMax);
+
+	const FIntVector OverlapMin(FMath::Max(PreviousMin.X, ShownMin.X), FMath::Max(PreviousMin.Y, ShownMin.Y), FMath::Max(PreviousMin.Z, ShownMin.Z));
+	const FIntVector OverlapMax(FMath::Min(PreviousMax.X, ShownMax.X), FMath::Min(PreviousMax.Y, ShownMax.Y), FMath::Min(PreviousMax.Z, ShownMax.Z));
+	if (OverlapMin.X <= OverlapMax.X && OverlapMin.Y <= OverlapMax.Y && OverlapMin.Z <= OverlapMax.Z)
+	{
+		AddBoxSurface(OverlapMin, OverlapMax);
+	}
+
+	Puzzle.GetStates().ForEachChanged([this, &CandidateBlocks, PreviousMin, PreviousMax](int32 MasterIndex, EBlockState State)
+	{
+		if (State != EBlockState::Crossed) return;
+
+		const FIntVector Index = Puzzle.GetIndexUnchecked(MasterIndex);
+		for (const FIntVector& Offset : NeighbourOffsets)
+		{
+			const FIntVector Neighbour = Index + Offset;
+			if (IsWithinBox(Neighbour, PreviousMin, PreviousMax) || IsWithinBox(Neighbour, ShownMin, ShownMax))
+			{
+				CandidateBlocks.Add(Puzzle.GetIndexUnchecked(Neighbour));
+			}
+		}
+	});
+
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> RemovedInstances;
+	TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>> AddedBlocks;
+	for (const int32 MasterIndex : CandidateBlocks)
+	{
+		UpdateBlockExposure(MasterIndex, RemovedInstances, AddedBlocks);
+	}
+	UpdateBlockInstances(RemovedInstances, AddedBlocks);
+}
+
+void APicrossGrid::CreateBlockInstances(const FIntVector Min, const FIntVector Max)
+{
+	if (!Puzzle.IsValid()) return;
+	if (!ensureAlwaysMsgf(Puzzle.IsValidIndex(Min) && Puzzle.IsValidIndex(Max), TEXT("Tried to create block instances outside of the grid."))) return;
+
+	TArray<FTransform> Transforms;
+	Puzzle.GetBlockTransforms(Min, Max, Transforms);
+
+	int32 TransformIndex = 0;
+	for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			const int32 RowStart = Puzzle.GetIndexUnchecked(0, Y, Z);
+			for (int32 X = Min.X; X <= Max.X; ++X, ++TransformIndex)
+			{
+				if (bCullEnclosedBlocks && !IsBlockExposed(FIntVector(X, Y, Z))) continue;
+
+				CreateBlockInstance(RowStart + X, Transforms[TransformIndex]);
+			}
+		}
+	}
+}
+
+void APicrossGrid::GenerateNumbers()
+{
+	CleanupNumbers();
+
+	if (IsLocked()) return;
+
+	GenerateNumbersForAxis(EAxis::X);
+	GenerateNumbersForAxis(EAxis::Y);
+	GenerateNumbersForAxis(EAxis::Z);
+}
 
-			CreatePicrossNumber(Axis, Axis1, Axis2, Numbers);
+void APicrossGrid::GenerateNumbersForAxis(EAxis::Type Axis)
+{
+	if (!Puzzle.IsValid()) return;
+
+	const FPicrossPuzzleClues& Clues = Puzzle.GetPuzzleData()->GetClues();
+
+	if (Clues.GridSize != Puzzle.GetGridSize()) return;
+
+	const FPicrossLineLayout Layout(Puzzle.GetGridSize(), Axis);
+	for (int32 Axis1 = 0; Axis1 < Layout.Axis1Size; ++Axis1)
+	{
+		for (int32 Axis2 = 0; Axis2 < Layout.Axis2Size; ++Axis2)
+		{
+			CreatePicrossNumber(Axis, Axis1, Axis2, Clues.GetClue(Axis, Layout.GetLineIndex(Axis1, Axis2)));
 		}
 	}
 }
 
-void APicrossGrid::CreatePicrossNumber(const EAxis::Type Axis, int32 Axis1, int32 Axis2, const FFormatOrderedArguments& Numbers)
+void APicrossGrid::CreatePicrossNumber(const EAxis::Type Axis, int32 Axis1, int32 Axis2, TArrayView<const uint16> Numbers)
 {
 	if (Numbers.Num() > 0)
 	{
@@ -376,27 +890,72 @@ void APicrossGrid::CreatePicrossNumber(const EAxis::Type Axis, int32 Axis1, int3
 			APicrossNumber* PicrossNumber = GetWorld()->SpawnActor<APicrossNumber>(PicrossNumberClass);
 			if (PicrossNumber)
 			{
-				const FIntVector BlockIndex = (Axis == EAxis::X ? FIntVector(0, Axis1, Axis2) : Axis == EAxis::Y ? FIntVector(Axis1, 0, Axis2) : FIntVector(Axis1, Axis2, Puzzle.Z() - 1));
-				const FPicrossBlock& Block = Puzzle[BlockIndex];
+				const FIntVector BlockIndex = GetNumberBlockIndex(Axis, Axis1, Axis2);
+				const FTransform BlockTransform = Puzzle.GetBlockTransform(BlockIndex);
 				const FVector RelativeLocation = (Axis == EAxis::X ? FVector(-75.f, 0.f, 50.f) : Axis == EAxis::Y ? FVector(0.f, -75.f, 50.f) : FVector(0.f, 0.f, 115.f)) * Puzzle.DynamicScale;
-				const FVector WorldLocation = Block.Transform.GetTranslation() + Block.Transform.GetRotation().RotateVector(RelativeLocation);
+				const FVector WorldLocation = BlockTransform.GetTranslation() + BlockTransform.GetRotation().RotateVector(RelativeLocation);
 				PicrossNumber->AttachToActor(this, FAttachmentTransformRules::KeepRelativeTransform);
 				PicrossNumber->SetActorLocation(WorldLocation);
 				PicrossNumber->SetActorRelativeRotation(FRotator::ZeroRotator);
 				PicrossNumber->SetActorScale3D(FVector(Puzzle.DynamicScale));
+
+				// Spawned hidden so only the numbers that end up shown generate their texts.
+				PicrossNumber->SetActorHiddenInGame(true);
 				PicrossNumber->Setup(Axis, Numbers);
+				PicrossNumber->UpdateRotation(SelectionAxis);
 
-				switch (Axis)
-				{
-					case EAxis::X: NumbersXAxis.Add(BlockIndex, PicrossNumber); break;
-					case EAxis::Y: NumbersYAxis.Add(BlockIndex, PicrossNumber); break;
-					case EAxis::Z: NumbersZAxis.Add(BlockIndex, PicrossNumber); break;
-				}
+				TPair<FIntVector, APicrossNumber*> Pair(BlockIndex, PicrossNumber);
+				UpdateNumberVisibility(Pair);
+				GetNumbersForAxis(Axis).Add(BlockIndex, PicrossNumber);
 			}
 		}
 	}
 }
 
+FIntVector APicrossGrid::GetNumberBlockIndex(const EAxis::Type Axis, int32 Axis1, int32 Axis2) const
+{
+	return (Axis == EAxis::X ? FIntVector(0, Axis1, Axis2) : Axis == EAxis::Y ? FIntVector(Axis1, 0, Axis2) : FIntVector(Axis1, Axis2, Puzzle.Z() - 1));
+}
+
+TMap<FIntVector, APicrossNumber*>& APicrossGrid::GetNumbersForAxis(const EAxis::Type Axis)
+{
+	return Axis == EAxis::X ? NumbersXAxis : Axis == EAxis::Y ? NumbersYAxis : NumbersZAxis;
+}
+
+void APicrossGrid::UpdateNumbersForLine(const EAxis::Type Axis, int32 Axis1, int32 Axis2, TArrayView<const uint16> Numbers)
+{
+	if (!Puzzle.IsValid() || IsLocked()) return;
+
+	const FIntVector BlockIndex = GetNumberBlockIndex(Axis, Axis1, Axis2);
+	TMap<FIntVector, APicrossNumber*>& AxisNumbers = GetNumbersForAxis(Axis);
+	APicrossNumber** ExistingNumber = AxisNumbers.Find(BlockIndex);
+	if (ExistingNumber && *ExistingNumber && Numbers.Num() > 0)
+	{
+		(*ExistingNumber)->Setup(Axis, Numbers);
+		(*ExistingNumber)->UpdateRotation(SelectionAxis);
+		return;
+	}
+
+	if (ExistingNumber)
+	{
+		if (*ExistingNumber) (*ExistingNumber)->Destroy();
+		AxisNumbers.Remove(BlockIndex);
+	}
+
+	CreatePicrossNumber(Axis, Axis1, Axis2, Numbers);
+}
+
+void APicrossGrid::UpdateNumberVisibility(TPair<FIntVector, APicrossNumber*>& Pair) const
+{
+	if (!Pair.Value) return;
+
+	const bool bShowAlways = SelectionAxis == EAxis::None;
+	const bool bSameAxis = SelectionAxis == Pair.Value->GetAxis();
+	const bool bCorrectIndex = (SelectionAxis == EAxis::X ? Pair.Key.X == FocusedBlock.X : SelectionAxis == EAxis::Y ? Pair.Key.Y == FocusedBlock.Y : Pair.Key.Z == FocusedBlock.Z);
+	const bool bShouldShow = (bShowAlways || (!bSameAxis && bCorrectIndex));
+	Pair.Value->SetShown(bShouldShow);
+}
+
 void APicrossGrid::ForEachPicrossNumber(const TFunctionRef<void(TPair<FIntVector, APicrossNumber*>&)> Func)
 {
 	Algo::ForEach(NumbersXAxis, Func);
@@ -417,19 +976,12 @@ void APicrossGrid::CleanupNumbers()
 void APicrossGrid::UpdateNumbersVisibility()
 {
 	const EAxis::Type Axis = SelectionAxis;
-	const FIntVector Index = FocusedBlock;
-	const auto ShowOrHide = [Axis, Index](TPair<FIntVector, APicrossNumber*>& Pair) -> void 
-	{
-		const bool bShowAlways = Axis == EAxis::None;
-		const bool bSameAxis = Axis == Pair.Value->GetAxis();
-		const bool bCorrectIndex = (Axis == EAxis::X ? Pair.Key.X == Index.X : Axis == EAxis::Y ? Pair.Key.Y == Index.Y : Pair.Key.Z == Index.Z);
-		const bool bShouldShow = (bShowAlways || (!bSameAxis && bCorrectIndex));
-		if (Pair.Value) Pair.Value->SetActorHiddenInGame(!bShouldShow);
-	};
+	const auto ShowOrHide = [this](TPair<FIntVector, APicrossNumber*>& Pair) -> void { UpdateNumberVisibility(Pair); };
 	const auto UpdateRotation = [Axis](TPair<FIntVector, APicrossNumber*>& Pair) -> void { if (Pair.Value) Pair.Value->UpdateRotation(Axis); };
 
-	ForEachPicrossNumber(ShowOrHide);
+	// Rotating first means the numbers that get hidden don't generate texts for the new alignment.
 	ForEachPicrossNumber(UpdateRotation);
+	ForEachPicrossNumber(ShowOrHide);
 }
 
 void APicrossGrid::Cycle2DRotation()
@@ -443,7 +995,7 @@ void APicrossGrid::Cycle2DRotation()
 		case EAxis::X:		SetRotationXAxis();	break;
 		case EAxis::Y:		SetRotationYAxis();	break;
 		case EAxis::Z:		SetRotationZAxis();	break;
-		case EAxis::None:	EnableAllBlocks();	break;
+		case EAxis::None:	ShowBlocks(FIntVector::ZeroValue, Puzzle.GetGridSize() - FIntVector(1));	break;
 	}
 
 	UpdateNumbersVisibility();
@@ -454,45 +1006,21 @@ void APicrossGrid::SetRotationXAxis()
 {
 	if (IsLocked()) return;
 
-	DisableAllBlocks();
-
-	for (int32 Z = 0; Z < Puzzle.Z(); ++Z)
-	{
-		for (int32 Y = 0; Y < Puzzle.Y(); ++Y)
-		{
-			CreateBlockInstance(Puzzle[FIntVector(FocusedBlock.X, Y, Z)]);
-		}
-	}
+	ShowBlocks(FIntVector(FocusedBlock.X, 0, 0), FIntVector(FocusedBlock.X, Puzzle.Y() - 1, Puzzle.Z() - 1));
 }
 
 void APicrossGrid::SetRotationYAxis()
 {
 	if (IsLocked()) return;
 
-	DisableAllBlocks();
-
-	for (int32 Z = 0; Z < Puzzle.Z(); ++Z)
-	{
-		for (int32 X = 0; X < Puzzle.X(); ++X)
-		{
-			CreateBlockInstance(Puzzle[FIntVector(X, FocusedBlock.Y, Z)]);
-		}
-	}
+	ShowBlocks(FIntVector(0, FocusedBlock.Y, 0), FIntVector(Puzzle.X() - 1, FocusedBlock.Y, Puzzle.Z() - 1));
 }
 
 void APicrossGrid::SetRotationZAxis()
 {
 	if (IsLocked()) return;
 
-	DisableAllBlocks();
-
-	for (int32 Y = 0; Y < Puzzle.Y(); ++Y)
-	{
-		for (int32 X = 0; X < Puzzle.X(); ++X)
-		{
-			CreateBlockInstance(Puzzle[FIntVector(X, Y, FocusedBlock.Z)]);
-		}
-	}
+	ShowBlocks(FIntVector(0, 0, FocusedBlock.Z), FIntVector(Puzzle.X() - 1, Puzzle.Y() - 1, FocusedBlock.Z));
 }
 
 void APicrossGrid::EnableAllBlocks()
@@ -500,11 +1028,10 @@ void APicrossGrid::EnableAllBlocks()
 	if (IsLocked()) return;
 
 	DisableAllBlocks();
+	ShownMin = FIntVector::ZeroValue;
+	ShownMax = Puzzle.GetGridSize() - FIntVector(1);
 
-	for (FPicrossBlock& Block : Puzzle)
-	{
-		CreateBlockInstance(Block);
-	}
+	CreateBlockInstances(FIntVector::ZeroValue, Puzzle.GetGridSize() - FIntVector(1));
 }
 
 void APicrossGrid::DisableAllBlocks()
@@ -518,10 +1045,12 @@ void APicrossGrid::DisableAllBlocks()
 			Pair.Value->ClearInstances();
 		}
 	}
-	for (FPicrossBlock& Block : Puzzle)
+
+	if (AllBlockInstances)
 	{
-		Block.InstanceIndex = INDEX_NONE;
+		AllBlockInstances->ClearInstances();
 	}
+	Puzzle.ResetInstanceIndices();
 }
 
 bool APicrossGrid::IsLocked() const
@@ -541,20 +1070,8 @@ void APicrossGrid::Unlock()
 
 bool APicrossGrid::IsSolved() const
 {
-	if (Puzzle.IsValid() && CurrentlyFilledBlocksCount == SolutionFilledBlocksCount)
-	{
-		const TArray<bool>& Solution = Puzzle.GetPuzzleData()->GetSolution();
-
-		for (int32 i = 0; i < Solution.Num(); ++i)
-		{
-			if (Puzzle[i].State != EBlockState::Filled && Solution[i])
-			{
-				return false;
-			}
-		}
-		return true;
-	}
-	return false;
+	// The counts differ on almost every edit, so the comparison of the whole grid is rarely needed.
+	return Puzzle.IsValid() && CurrentlyFilledBlocksCount == SolutionFilledBlocksCount && FilledBlocks == Puzzle.GetPuzzleData()->GetSolution();
 }
 
 void APicrossGrid::TrySolve()
@@ -564,6 +1081,7 @@ void APicrossGrid::TrySolve()
 		SelectionAxis = EAxis::None;
 		EnableOnlyFilledBlocks();
 		Lock();
+		RestartHint();
 		HighlightBlocks();
 		GenerateNumbers();
 		DeleteSaveGame();
@@ -571,26 +1089,33 @@ void APicrossGrid::TrySolve()
 	}
 }
 
-void APicrossGrid::SaveGame() const
+void APicrossGrid::SaveGame()
 {
-	if (Puzzle.IsValid() && !IsSolved())
+	if (Puzzle.IsValid() && !IsSolved() && Puzzle.GetStates().IsDirty())
 	{
-		if (UPicrossPuzzleSaveGame* SaveGameInstance = Cast<UPicrossPuzzleSaveGame>(UGameplayStatics::CreateSaveGameObject(UPicrossPuzzleSaveGame::StaticClass())))
+		if (!CurrentSaveGame)
 		{
-			for (FPicrossBlock Block : Puzzle)
-			{
-				SaveGameInstance->PicrossBlockStates.Add(Block.State);
-			}
+			CurrentSaveGame = Cast<UPicrossPuzzleSaveGame>(UGameplayStatics::CreateSaveGameObject(UPicrossPuzzleSaveGame::StaticClass()));
+		}
+
+		if (CurrentSaveGame)
+		{
+			CurrentSaveGame->UpdateStates(Puzzle.GetStates());
 
 			const FString SaveSlotName = Puzzle.GetPuzzleData()->GetFName().ToString();
 			static const int32 UserIndex = 0;
-			UGameplayStatics::SaveGameToSlot(SaveGameInstance, SaveSlotName, UserIndex);
+			if (UGameplayStatics::SaveGameToSlot(CurrentSaveGame, SaveSlotName, UserIndex))
+			{
+				Puzzle.ClearDirtyStates();
+			}
 		}
 	}
 }
 
 void APicrossGrid::LoadGame()
 {
+	CurrentSaveGame = nullptr;
+
 	if (Puzzle.IsValid())
 	{
 		const FString SaveSlotName = Puzzle.GetPuzzleData()->GetFName().ToString();
@@ -600,24 +1125,45 @@ void APicrossGrid::LoadGame()
 		{
 			if (UPicrossPuzzleSaveGame* LoadedGame = Cast<UPicrossPuzzleSaveGame>(UGameplayStatics::LoadGameFromSlot(SaveSlotName, UserIndex)))
 			{
-				const bool bSameSize = Puzzle.GetGrid().Num() == LoadedGame->PicrossBlockStates.Num();
-				if (bSameSize)
+				TPicrossChunkedArray<EBlockState> LoadedStates;
+				if (LoadedGame->GetStates(Puzzle.Num(), LoadedStates))
 				{
-					for (int32 Index = 0; Index < Puzzle.GetGrid().Num(); ++Index)
+					TArray<int32> ChangedBlocks;
+					FilledBlocks.Init(Puzzle.Num());
+					const TPicrossChunkedArray<EBlockState>& States = Puzzle.GetStates();
+					for (int32 ChunkIndex = 0; ChunkIndex < States.NumChunks(); ++ChunkIndex)
 					{
-						Puzzle[Index].State = LoadedGame->PicrossBlockStates[Index];
+						// A chunk that is clear both in the grid and in the save has nothing to load.
+						if (States.GetChunk(ChunkIndex).Num() == 0 && LoadedStates.GetChunk(ChunkIndex).Num() == 0) continue;
+
+						const int32 Start = ChunkIndex * States.ChunkSize;
+						const int32 End = FMath::Min(Start + States.ChunkSize, Puzzle.Num());
+						for (int32 Index = Start; Index < End; ++Index)
+						{
+							if (Puzzle.GetState(Index) != LoadedStates[Index])
+							{
+								ChangedBlocks.Add(Index);
+							}
+							Puzzle.SetState(Index, LoadedStates[Index]);
+							FilledBlocks.Set(Index, Puzzle.GetState(Index) == EBlockState::Filled);
+						}
 					}
+					Puzzle.ClearDirtyStates();
+					CurrentSaveGame = LoadedGame;
 
-					CurrentlyFilledBlocksCount = Algo::CountIf(Puzzle.GetGrid(), [](FPicrossBlock Block) { return Block.State == EBlockState::Filled; });
+					CurrentlyFilledBlocksCount = FilledBlocks.CountFilled();
 					EnableAllBlocks();
+					HandleBlocksChanged(ChangedBlocks);
 				}
 			}
 		}
 	}
 }
 
-void APicrossGrid::DeleteSaveGame() const
+void APicrossGrid::DeleteSaveGame()
 {
+	CurrentSaveGame = nullptr;
+
 	if (Puzzle.IsValid())
 	{
 		const FString SaveSlotName = Puzzle.GetPuzzleData()->GetFName().ToString();
@@ -679,9 +1225,9 @@ void APicrossGrid::Move2DSelectionDown()
 
 void APicrossGrid::SetFocusedBlock(const int32 MasterIndex)
 {
-	if (MasterIndex != INDEX_NONE && FocusedBlock != Puzzle.GetIndex(MasterIndex) && Puzzle.GetGrid().IsValidIndex(MasterIndex))
+	if (Puzzle.IsValidIndex(MasterIndex) && FocusedBlock != Puzzle.GetIndexUnchecked(MasterIndex))
 	{
-		FocusedBlock = Puzzle.GetIndex(MasterIndex);
+		FocusedBlock = Puzzle.GetIndexUnchecked(MasterIndex);
 		HighlightBlocks();
 	}
 }
@@ -777,7 +1323,7 @@ TOptional<FTransform> APicrossGrid::GetIdealPawnTransform(const APawn* Pawn) con
 			GetActorBounds(true, Origin, BoxExtent, true);
 			return Origin;
 		}();
-		const FVector Pivot = Puzzle[FocusedBlock].Transform.GetLocation();
+		const FVector Pivot = Puzzle.GetBlockLocation(FocusedBlock);
 		const FVector PivotedOrigin = FVector{
 			SelectionAxis == EAxis::X ? Pivot.X : Origin.X,
 			SelectionAxis == EAxis::Y ? Pivot.Y : Origin.Y,
@@ -796,6 +1342,7 @@ TOptional<FTransform> APicrossGrid::GetIdealPawnTransform(const APawn* Pawn) con
 void APicrossGrid::LoadPuzzle(FAssetData PuzzleToLoad)
 {
 	SaveGame();
+	CurrentSaveGame = nullptr;
 
 	Puzzle = FPicrossPuzzle(Cast<UPicrossPuzzleData>(PuzzleToLoad.GetAsset()));
 	if (Puzzle.IsValid())
@@ -7,6 +7,7 @@
 #include "CoreMinimal.h"
 #include "FArray3D.h"
 #include "PicrossBlock.h"
+#include "PicrossChunkedArray.h"
 #include "PicrossPuzzleData.h"
 #include "GameFramework/Actor.h"
 #include "Misc/Optional.h"
@@ -17,7 +18,11 @@
 // Forward declarations
 class APicrossNumber;
 class ATextRenderActor;
+class FPicrossHintEngine;
+struct FPicrossHint;
 class UHierarchicalInstancedStaticMeshComponent;
+class UInstancedStaticMeshComponent;
+class UPicrossPuzzleSaveGame;
 
 /**
  * Struct representing the action taken on a single block.
@@ -48,7 +53,11 @@ struct FPicrossAction
 };
 
 /**
- * Struct representing a 3D collection of FPicrossBlock, has a GridSize and Array.
+ * Struct representing a 3D collection of blocks, has a GridSize and one array per block attribute.
+ * The states are chunked so clear blocks cost nothing, which keeps the memory of large mostly untouched puzzles proportional to the touched blocks.
+ * The instance indices are chunked the same way, so with enclosed blocks culled they scale with the surface of the grid instead of its volume.
+ * Everything else about a block follows from its index, the transform is computed from the grid basis when it's needed.
+ * The dimensions are cached when constructed, the Unchecked accessors skip all validation and are meant for loops whose bounds were checked up front.
  */
 USTRUCT(BlueprintType)
 struct FPicrossPuzzle
@@ -58,7 +67,20 @@ struct FPicrossPuzzle
 public:
 	// Constructors & Assignments
 	FPicrossPuzzle() : Puzzle(nullptr) {}
-	FPicrossPuzzle(UPicrossPuzzleData* Puzzle) : Puzzle(Puzzle) { if(Puzzle) Grid.SetNum(FArray3D::Size(Puzzle->GetGridSize())); }
+	FPicrossPuzzle(UPicrossPuzzleData* Puzzle) : Puzzle(Puzzle)
+	{
+		if (Puzzle)
+		{
+			GridSize = Puzzle->GetGridSize();
+			StrideZ = GridSize.X * GridSize.Y;
+			// Puzzles that are invalid or too big for the block instances get no blocks, which is what IsValid checks.
+			// Counted in 64 bits so a puzzle past MAX_int32 blocks is reported with its real size instead of overflowing.
+			const int64 NumBlocks = FArray3D::ValidateDimensions64(GridSize) ? FArray3D::Size64(GridSize) : 0;
+			const bool bAddressable = ensureMsgf(NumBlocks <= MaxNum, TEXT("Puzzle has more blocks than the block instances can address. Blocks: %lld Max: %d"), NumBlocks, MaxNum);
+			States.Init(EBlockState::Clear, bAddressable ? static_cast<int32>(NumBlocks) : 0);
+			InstanceIndices.Init(INDEX_NONE, States.Num());
+		}
+	}
 	FPicrossPuzzle(const FPicrossPuzzle&) = default;
 	FPicrossPuzzle(FPicrossPuzzle&&) = default;
 	FPicrossPuzzle& operator=(const FPicrossPuzzle&) = default;
@@ -67,35 +89,74 @@ public:
 	// Getters
 	UPicrossPuzzleData* GetPuzzleData() { return Puzzle; }
 	UPicrossPuzzleData const* const GetPuzzleData() const { return Puzzle; }
-	FIntVector GetGridSize() const { return Puzzle ? Puzzle->GetGridSize() : FIntVector(INDEX_NONE); }
-	int32 X() const { return Puzzle ? Puzzle->GetGridSize().X : INDEX_NONE; }
-	int32 Y() const { return Puzzle ? Puzzle->GetGridSize().Y : INDEX_NONE; }
-	int32 Z() const { return Puzzle ? Puzzle->GetGridSize().Z : INDEX_NONE; }
-	TArray<FPicrossBlock>& GetGrid() { return Grid; }
-	const TArray<FPicrossBlock>& GetGrid() const { return Grid; }
-	int32 GetIndex(FIntVector ThreeDimensionalIndex) const { return Puzzle ? FArray3D::TranslateTo1D(Puzzle->GetGridSize(), ThreeDimensionalIndex) : INDEX_NONE; }
-	FIntVector GetIndex(int32 OneDimensionalIndex) const { return Puzzle ? FArray3D::TranslateTo3D(Puzzle->GetGridSize(), OneDimensionalIndex) : FIntVector(INDEX_NONE); }
-	bool IsValid() const { return (Puzzle != nullptr && FArray3D::ValidateDimensions(Puzzle->GetGridSize())); }
-
-	// Ranged for redirection
-	auto begin() { return Grid.begin(); }
-	auto begin() const { return Grid.begin(); }
-	auto end() { return Grid.end(); }
-	auto end() const { return Grid.end(); }
-
-	// Functions to access the array
-	FPicrossBlock& operator[](int32 OneDimensionalIndex) { return Grid[OneDimensionalIndex]; }
-	const FPicrossBlock& operator[](int32 OneDimensionalIndex) const { return Grid[OneDimensionalIndex]; }
-	FPicrossBlock& operator[](FIntVector ThreeDimensionalIndex) { return Grid[GetIndex(ThreeDimensionalIndex)]; }
-	const FPicrossBlock& operator[](FIntVector ThreeDimensionalIndex) const { return Grid[GetIndex(ThreeDimensionalIndex)]; }
+	FIntVector GetGridSize() const { return GridSize; }
+	int32 X() const { return GridSize.X; }
+	int32 Y() const { return GridSize.Y; }
+	int32 Z() const { return GridSize.Z; }
+	int32 Num() const { return States.Num(); }
+	bool IsValidIndex(int32 OneDimensionalIndex) const { return States.IsValidIndex(OneDimensionalIndex); }
+	bool IsValidIndex(FIntVector ThreeDimensionalIndex) const { return ThreeDimensionalIndex.X >= 0 && ThreeDimensionalIndex.X < GridSize.X && ThreeDimensionalIndex.Y >= 0 && ThreeDimensionalIndex.Y < GridSize.Y && ThreeDimensionalIndex.Z >= 0 && ThreeDimensionalIndex.Z < GridSize.Z; }
+	int32 GetIndex(FIntVector ThreeDimensionalIndex) const { return Puzzle ? FArray3D::TranslateTo1D(GridSize, ThreeDimensionalIndex) : INDEX_NONE; }
+	FIntVector GetIndex(int32 OneDimensionalIndex) const { return Puzzle ? FArray3D::TranslateTo3D(GridSize, OneDimensionalIndex) : FIntVector(INDEX_NONE); }
+	FORCEINLINE int32 GetIndexUnchecked(int32 InX, int32 InY, int32 InZ) const { checkSlow(IsValidIndex(FIntVector(InX, InY, InZ))); return InZ * StrideZ + InY * GridSize.X + InX; }
+	FORCEINLINE int32 GetIndexUnchecked(FIntVector ThreeDimensionalIndex) const { return GetIndexUnchecked(ThreeDimensionalIndex.X, ThreeDimensionalIndex.Y, ThreeDimensionalIndex.Z); }
+	FORCEINLINE FIntVector GetIndexUnchecked(int32 OneDimensionalIndex) const
+	{
+		checkSlow(IsValidIndex(OneDimensionalIndex));
+		const int32 InZ = OneDimensionalIndex / StrideZ;
+		const int32 InXY = OneDimensionalIndex - InZ * StrideZ;
+		return FIntVector(InXY % GridSize.X, InXY / GridSize.X, InZ);
+	}
+	bool IsValid() const { return Puzzle != nullptr && Num() > 0; }
+
+	// The MasterIndex is stored as a float in the custom data of the block instances, which is exact for every integer up to 2^24.
+	static constexpr int32 MaxNum = 1 << 24;
+
+	// Block states, in MasterIndex order. A chunk of states is dirty when any of its blocks changed since the last save or load, only saving uses the flags.
+	const TPicrossChunkedArray<EBlockState>& GetStates() const { return States; }
+	void ClearDirtyStates() { States.ClearDirty(); }
+	EBlockState GetState(int32 OneDimensionalIndex) const { check(IsValidIndex(OneDimensionalIndex)); return States[OneDimensionalIndex]; }
+	EBlockState GetState(FIntVector ThreeDimensionalIndex) const { return States[GetIndex(ThreeDimensionalIndex)]; }
+	void SetState(int32 OneDimensionalIndex, EBlockState NewState) { check(IsValidIndex(OneDimensionalIndex)); States.Set(OneDimensionalIndex, NewState); }
+	FORCEINLINE EBlockState GetStateUnchecked(int32 OneDimensionalIndex) const { return States[OneDimensionalIndex]; }
+
+	// Index of the instance of a block in the component of its state, INDEX_NONE while the block isn't shown.
+	int32 GetInstanceIndex(int32 OneDimensionalIndex) const { check(IsValidIndex(OneDimensionalIndex)); return InstanceIndices[OneDimensionalIndex]; }
+	void SetInstanceIndex(int32 OneDimensionalIndex, int32 InstanceIndex) { check(IsValidIndex(OneDimensionalIndex)); InstanceIndices.Set(OneDimensionalIndex, InstanceIndex); }
+	void ResetInstanceIndices() { InstanceIndices.Init(INDEX_NONE, States.Num()); }
+
+	/**
+	 * Sets the basis the blocks are laid out in, block XYZ is placed at Origin + X * StepX + Y * StepY + Z * StepZ.
+	 */
+	void SetBasis(const FVector& InOrigin, const FQuat& InRotation, const FVector& StepX, const FVector& StepY, const FVector& StepZ);
+	FVector GetBlockLocation(FIntVector ThreeDimensionalIndex) const { return Origin + Steps[0] * ThreeDimensionalIndex.X + Steps[1] * ThreeDimensionalIndex.Y + Steps[2] * ThreeDimensionalIndex.Z; }
+	FTransform GetBlockTransform(FIntVector ThreeDimensionalIndex) const { return FTransform(Rotation, GetBlockLocation(ThreeDimensionalIndex), FVector(DynamicScale)); }
+	FTransform GetBlockTransform(int32 OneDimensionalIndex) const { return GetBlockTransform(GetIndex(OneDimensionalIndex)); }
+	/**
+	 * Computes the transforms of every block in the box [Min, Max] in MasterIndex order, stepping along the basis instead of translating every index.
+	 */
+	void GetBlockTransforms(FIntVector Min, FIntVector Max, TArray<FTransform>& OutTransforms) const;
+	/**
+	 * Computes the transforms of the blocks at OneDimensionalIndices in the same order, translating all of the indices in one batch.
+	 * @returns false if any index is outside of the grid, OutTransforms is left empty then.
+	 */
+	bool GetBlockTransforms(TArrayView<const int32> OneDimensionalIndices, TArray<FTransform>& OutTransforms) const;
 
 	float DynamicScale = 1.f;
 
 private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Picross Grid", meta = (AllowPrivateAccess = "true"))
 	UPicrossPuzzleData* Puzzle;
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Picross Grid", meta = (AllowPrivateAccess = "true"))
-	TArray<FPicrossBlock> Grid;
+	TPicrossChunkedArray<EBlockState> States;
+	TPicrossChunkedArray<int32> InstanceIndices;
+
+	// Cached from the puzzle data so indexing never has to go through the pointer.
+	FIntVector GridSize = FIntVector(INDEX_NONE);
+	int32 StrideZ = 0;
+
+	FVector Origin = FVector::ZeroVector;
+	FVector Steps[3] = { FVector::ZeroVector, FVector::ZeroVector, FVector::ZeroVector };
+	FQuat Rotation = FQuat::Identity;
 };
 
 /**
@@ -109,6 +170,11 @@ class PICROSS_API APicrossGrid : public AActor
 public:	
 	// Sets default values for this actor's properties
 	APicrossGrid();
+
+	// Custom data of the block instances, stored as float so cast to int32 required when reading.
+	static constexpr int32 MasterIndexCustomDataIndex = 0;
+	// Only on the single instance component, the EBlockState of the block.
+	static constexpr int32 StateCustomDataIndex = 1;
 	
 	bool IsLocked() const;
 
@@ -140,6 +206,17 @@ public:
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FPuzzleLoaded);
 	FPuzzleLoaded& OnPuzzleLoaded() { return PuzzleLoaded; }
 
+	/**
+	 * While enabled a background search keeps looking for the next cells the player can deduce and highlights them, restarting whenever the grid changes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Picross")
+	void SetHintsEnabled(bool bEnabled);
+	UFUNCTION(BlueprintPure, Category = "Picross")
+	bool AreHintsEnabled() const { return bHintsEnabled; }
+
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE(FHintFound);
+	FHintFound& OnHintFound() { return HintFound; }
+
 protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
@@ -149,6 +226,18 @@ protected:
 	void ClearGrid();
 	void DestroyGrid();
 
+	/**
+	 * Called after the player changed the state of blocks.
+	 * @param ChangedBlocks - The MasterIndex of every block whose state changed.
+	 */
+	virtual void HandleBlocksChanged(TArrayView<const int32> ChangedBlocks);
+
+	/**
+	 * Replaces the numbers of a single line, removing them if there are none.
+	 * @param Numbers - The clue of the line in order along the line, as in FPicrossPuzzleClues.
+	 */
+	void UpdateNumbersForLine(const EAxis::Type Axis, int32 Axis1, int32 Axis2, TArrayView<const uint16> Numbers);
+
 	// The Picross Puzzle that we work with.
 	UPROPERTY()
 	FPicrossPuzzle Puzzle;
@@ -157,11 +246,16 @@ protected:
 	int32 SolutionFilledBlocksCount = -1;
 	// The total amount of filled blocks in the puzzle.
 	int32 CurrentlyFilledBlocksCount = 0;
+	// Which blocks are filled, packed the same way as the solution so the two can be compared a word at a time.
+	FPicrossSolution FilledBlocks;
 
 private:
 	void GenerateNumbers();
 	void GenerateNumbersForAxis(const EAxis::Type Axis);
-	void CreatePicrossNumber(const EAxis::Type Axis, int32 Axis1, int32 Axis2, const FFormatOrderedArguments& Numbers);
+	void CreatePicrossNumber(const EAxis::Type Axis, int32 Axis1, int32 Axis2, TArrayView<const uint16> Numbers);
+	FIntVector GetNumberBlockIndex(const EAxis::Type Axis, int32 Axis1, int32 Axis2) const;
+	TMap<FIntVector, APicrossNumber*>& GetNumbersForAxis(const EAxis::Type Axis);
+	void UpdateNumberVisibility(TPair<FIntVector, APicrossNumber*>& Pair) const;
 	void ForEachPicrossNumber(const TFunctionRef<void(TPair<FIntVector, APicrossNumber*>&)> Func);
 	void CleanupNumbers();
 	void UpdateNumbersVisibility();
@@ -169,11 +263,64 @@ private:
 	void SetRotationXAxis();
 	void SetRotationYAxis();
 	void SetRotationZAxis();
-
-	void UpdateBlockState(FPicrossBlock& Block, const EBlockState NewState);
-	void CreateBlockInstance(FPicrossBlock& Block) const;
+	/**
+	 * Shows the blocks in the box [Min, Max] and hides every other block without removing any instance.
+	 * Hidden instances are scaled to zero, which also removes their collision so traces reach the shown blocks behind them.
+	 * Only the blocks that leave or enter the box are updated, so moving between slices touches two slices instead of the whole grid.
+	 */
+	void ShowBlocks(const FIntVector Min, const FIntVector Max);
+	bool IsBlockShown(const int32 MasterIndex) const;
+	bool IsBlockShown(const FIntVector Index) const;
+
+	/**
+	 * Changes the state of many blocks as one edit, moving their instances between the components of the states in bulk.
+	 * Every component removes and adds its instances with one call each and rebuilds its tree once, and the solved check runs once at the end.
+	 * Blocks without an instance or already in their new state are skipped.
+	 * @param Changes - The MasterIndex and new state of every block to change, each block at most once.
+	 */
+	void UpdateBlockStates(TArrayView<const TPair<int32, EBlockState>> Changes);
+	/**
+	 * Removes and adds instances in bulk, fixing up the InstanceIndex of every block whose instance moved and rebuilding the tree of every changed component once.
+	 * @param RemovedInstances - The instances to remove from each component, their blocks must already be set to INDEX_NONE.
+	 * @param AddedBlocks - The MasterIndex of the blocks to add to each component.
+	 */
+	void UpdateBlockInstances(const TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, const TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks);
+	/**
+	 * @returns true if the block is shown and a neighbour of it is outside the grid, hidden or crossed, so the block can be seen.
+	 */
+	bool IsBlockExposed(const FIntVector Index) const;
+	/**
+	 * Queues the instances to add or remove so the changed blocks and their neighbours have an instance exactly when they are exposed.
+	 */
+	void CullEnclosedBlocks(TArrayView<const int32> ChangedBlocks, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks);
+	/**
+	 * Queues the instance to add or remove so the block has an instance exactly when it is exposed.
+	 */
+	void UpdateBlockExposure(const int32 MasterIndex, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& RemovedInstances, TMap<UHierarchicalInstancedStaticMeshComponent*, TArray<int32>>& AddedBlocks);
+	/**
+	 * Adds and removes the instances of the blocks whose exposure changed when the shown box changed from [PreviousMin, PreviousMax], without visiting every block that changed visibility.
+	 */
+	void CullShownBlocks(const FIntVector PreviousMin, const FIntVector PreviousMax);
+	// The component holding the instance of the block in its current state.
+	UHierarchicalInstancedStaticMeshComponent* GetBlockInstances(const int32 MasterIndex) const;
+	void CreateBlockInstance(const int32 MasterIndex);
+	void CreateBlockInstance(const int32 MasterIndex, const FTransform& Transform);
+	/**
+	 * Creates the instances of every block in the box [Min, Max], skipping enclosed blocks while bCullEnclosedBlocks is set.
+	 */
+	void CreateBlockInstances(const FIntVector Min, const FIntVector Max);
+	/**
+	 * Highlights the lines through the focused block, moving the pooled highlight instances in one batch and doing nothing if neither the focus nor the axis changed.
+	 */
 	void HighlightBlocks();
-	void HighlightBlocksInAxis(const EAxis::Type AxisToHighlight);
+	/**
+	 * Appends the transforms of the highlight instances along AxisToHighlight through the focused block, scaled to zero unless bShown.
+	 */
+	void GetHighlightTransforms(const EAxis::Type AxisToHighlight, const bool bShown, TArray<FTransform>& OutTransforms) const;
+
+	void RestartHint();
+	void ClearHint();
+	void ShowHint(const FPicrossHint& Hint);
 
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Picross")
 	void EnableOnlyFilledBlocks();
@@ -187,12 +334,16 @@ private:
 	bool IsSolved() const;
 	void TrySolve() ;
 
+	/**
+	 * Saves the state of every block, unless no block changed since the last save or load.
+	 * Only the chunks of states that changed since are copied into the save.
+	 */
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Picross")
-	void SaveGame() const;
+	void SaveGame();
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Picross")
 	void LoadGame();
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Picross")
-	void DeleteSaveGame() const;
+	void DeleteSaveGame();
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
 	TMap<EBlockState, UStaticMesh*> BlockMeshes;
@@ -200,13 +351,49 @@ private:
 	TMap<EBlockState, UMaterialInstance*> BlockMaterials;
 	UPROPERTY()
 	TMap<EBlockState, UHierarchicalInstancedStaticMeshComponent*> BlockInstances;
+
+	/**
+	 * Draws every block with one instanced component instead of one per state, the material switches on the state in custom data so changing a state never removes or adds an instance.
+	 * Blocks then share the SingleBlockMesh, which is also what the hit detection of the pawn traces against.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
+	bool bSingleInstanceComponent = false;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true", EditCondition = "bSingleInstanceComponent"))
+	UStaticMesh* SingleBlockMesh = nullptr;
+	// Reads the state from per instance custom data StateCustomDataIndex: 0 Clear, 1 Crossed, 2 Filled.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true", EditCondition = "bSingleInstanceComponent"))
+	UMaterialInstance* SingleBlockMaterial = nullptr;
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* AllBlockInstances = nullptr;
+	/**
+	 * Only instances blocks with an exposed face, blocks enclosed by clear or filled blocks on all six sides get no instance until a neighbour is crossed or hidden.
+	 * Saves the instance memory, culling and collision of the interior of large grids, the solved view still instances every filled block.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
+	bool bCullEnclosedBlocks = false;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
 	UStaticMesh* HighlightMesh = nullptr;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
 	UMaterialInstance* HighlightMaterial = nullptr;
+	// A plain instanced component, the pool is only X+Y+Z instances so a cluster tree isn't worth rebuilding on every focus change.
+	UPROPERTY()
+	UInstancedStaticMeshComponent* HighlightedBlocks = nullptr;
+	// What the highlight instances currently show, one bit per axis from X to Z.
+	FIntVector HighlightedFocus = FIntVector::ZeroValue;
+	uint8 HighlightedAxes = 0;
+	// Set when the grid is created, the pool is then resized or moved to the new blocks.
+	bool bHighlightsOutdated = true;
+
+	// Uses the HighlightMesh.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
+	UMaterialInstance* HintMaterial = nullptr;
 	UPROPERTY()
-	UHierarchicalInstancedStaticMeshComponent* HighlightedBlocks = nullptr;
+	UHierarchicalInstancedStaticMeshComponent* HintedBlocks = nullptr;
+
+	// Runs the hint search on the task graph, only ever touched from the game thread.
+	TSharedPtr<FPicrossHintEngine> HintEngine;
+	bool bHintsEnabled = false;
 
 	UPROPERTY(EditAnywhere, Category = "Picross", meta = (AllowPrivateAccess = "true"))
 	TSubclassOf<APicrossNumber> PicrossNumberClass = nullptr;
@@ -217,6 +404,10 @@ private:
 	UPROPERTY()
 	TMap<FIntVector, APicrossNumber*> NumbersZAxis;
 
+	// The save of the current puzzle as it was last written or read, saving copies the dirty chunks of states into it.
+	UPROPERTY()
+	UPicrossPuzzleSaveGame* CurrentSaveGame = nullptr;
+
 	UPROPERTY()
 	TArray<FPicrossAction> UndoStack;
 	UPROPERTY()
@@ -230,6 +421,9 @@ private:
 	TEnumAsByte<EAxis::Type> SelectionAxis = EAxis::None;
 	// Index for focused block, will be used as pivot for example.
 	FIntVector FocusedBlock = FIntVector::ZeroValue;
+	// The box of blocks that are shown, instances of blocks outside of it are hidden.
+	FIntVector ShownMin = FIntVector::ZeroValue;
+	FIntVector ShownMax = FIntVector::ZeroValue;
 	// Lock that we can set when solution has been found so the player can't edit finished puzzles.
 	bool bLocked = false;
 
@@ -238,4 +432,7 @@ private:
 
 	UPROPERTY(BlueprintAssignable, Category = "Picross")
 	FPuzzleLoaded PuzzleLoaded;
+
+	UPROPERTY(BlueprintAssignable, Category = "Picross")
+	FHintFound HintFound;
 };
@@ -4,6 +4,7 @@
 #include "PicrossNumber.h"
 #include "Components/TextRenderComponent.h"
 #include "Materials/MaterialInstance.h"
+#include "Algo/Reverse.h"
 
 // Sets default values
 APicrossNumber::APicrossNumber()
@@ -33,10 +34,12 @@ APicrossNumber::APicrossNumber()
 	}
 }
 
-void APicrossNumber::Setup(const EAxis::Type AxisToSet, const FFormatOrderedArguments& NumbersToSet)
+void APicrossNumber::Setup(const EAxis::Type AxisToSet, TArrayView<const uint16> NumbersToSet)
 {
 	Axis = AxisToSet;
-	Numbers = NumbersToSet;
+	Numbers = TArray<uint16>(NumbersToSet.GetData(), NumbersToSet.Num());
+	if (Axis == EAxis::Z) Algo::Reverse(Numbers); // Z-axis numbers are read from the top, the opposite side of where the clue starts.
+	bTextsOutdated = true;
 
 	const FColor Color = Axis == EAxis::Z ? FColor::Blue : Axis == EAxis::Y ? FColor::Green : FColor::Red;
 	MainText->SetTextRenderColor(Color);
@@ -70,6 +73,12 @@ void APicrossNumber::UpdateRotation(const EAxis::Type GridSelectionAxis)
 	}
 }
 
+void APicrossNumber::SetShown(const bool bShown)
+{
+	SetActorHiddenInGame(!bShown);
+	GenerateTexts();
+}
+
 void APicrossNumber::GenerateTexts()
 {
 	if (Numbers.Num() > 0)
@@ -77,12 +86,21 @@ void APicrossNumber::GenerateTexts()
 		if (MainText && ReversedText)
 		{
 			const bool bVerticalText = (MainText->VerticalAlignment == EVerticalTextAligment::EVRTA_TextBottom && MainText->HorizontalAlignment == EHorizTextAligment::EHTA_Center);
-			const FText Delimiter = FText::FromString(bVerticalText ? TEXT("\n") : TEXT(", "));
-			MainText->Text = FText::Join(Delimiter, Numbers);
+			bTextsOutdated |= bVerticalText != bVerticalTexts;
+			if (!bTextsOutdated || IsHidden()) return;
+
+			FString Joined;
+			for (int32 Index = 0; Index < Numbers.Num(); ++Index)
+			{
+				if (Index > 0) Joined += bVerticalText ? TEXT("\n") : TEXT(", ");
+				Joined.AppendInt(Numbers[Index]);
+			}
 
-			FFormatOrderedArguments ReversedNumbers = Numbers;
-			Algo::Reverse(ReversedNumbers);
-			ReversedText->Text = FText::Join(Delimiter, Numbers);
+			const FText Text = FText::FromString(MoveTemp(Joined));
+			MainText->SetText(Text);
+			ReversedText->SetText(Text);
+			bVerticalTexts = bVerticalText;
+			bTextsOutdated = false;
 		}
 	}
 }
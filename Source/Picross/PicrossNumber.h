@@ -82,11 +82,21 @@ public:
 	// Sets default values for this actor's properties
 	APicrossNumber();
 
-	void Setup(const EAxis::Type AxisToSet, const FFormatOrderedArguments& NumbersToSet);
+	/**
+	 * @param NumbersToSet - The clue of the line in order along the line, the Z-axis numbers are displayed reversed.
+	 */
+	void Setup(const EAxis::Type AxisToSet, TArrayView<const uint16> NumbersToSet);
 	void UpdateRotation(const EAxis::Type GridSelectionAxis);
 	EAxis::Type GetAxis() const { return Axis; }
+	/**
+	 * Shows or hides the numbers, the texts are only generated while shown.
+	 */
+	void SetShown(const bool bShown);
 
 protected:
+	/**
+	 * Generates the texts if they're outdated, or marks them outdated while hidden so they're generated once shown.
+	 */
 	void GenerateTexts();
 
 private:
@@ -102,7 +112,10 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Numbers", meta = (AllowPrivateAccess = "true"))
 	UMaterialInstance* NumbersTextMaterial = nullptr;
 
-	FFormatOrderedArguments Numbers;
+	// The numbers in display order.
+	TArray<uint16> Numbers;
+	bool bTextsOutdated = true;
+	bool bVerticalTexts = false;
 	UPROPERTY(VisibleInstanceOnly)
 	TEnumAsByte<EAxis::Type> Axis = EAxis::Type::None;
 };
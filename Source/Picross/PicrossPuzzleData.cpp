@@ -2,6 +2,8 @@
 
 
 #include "PicrossPuzzleData.h"
+#include "PicrossCustomVersion.h"
+#include "Solver/PicrossDifficultyRater.h"
 
 FIntVector UPicrossPuzzleData::GetGridSize() const
 {
@@ -11,16 +13,71 @@ FIntVector UPicrossPuzzleData::GetGridSize() const
 void UPicrossPuzzleData::SetGridSize(FIntVector NewGridSize)
 {
 	GridSize = NewGridSize;
+	Difficulty = -1.f;
+	UpdateClues();
 }
 
-const TArray<bool>& UPicrossPuzzleData::GetSolution() const
+const FPicrossSolution& UPicrossPuzzleData::GetSolution() const
 {
-	return PicrossSolution;
+	return PackedSolution;
 }
 
-void UPicrossPuzzleData::SetSolution(const TArray<bool> Solution)
+void UPicrossPuzzleData::SetSolution(const TArray<bool>& Solution)
 {
-	PicrossSolution = Solution;
+	PackedSolution.FromBools(Solution);
+	FilledCells = PackedSolution.CountFilled();
+	Difficulty = -1.f;
+	UpdateClues();
+}
+
+void UPicrossPuzzleData::SetSolution(FPicrossSolution Solution)
+{
+	PackedSolution = MoveTemp(Solution);
+	FilledCells = PackedSolution.CountFilled();
+	Difficulty = -1.f;
+	UpdateClues();
+}
+
+const FPicrossPuzzleClues& UPicrossPuzzleData::GetClues() const
+{
+	return Clues;
+}
+
+void UPicrossPuzzleData::UpdateClues()
+{
+	if (!ValidatePuzzle() || !Clues.Generate(GridSize, PackedSolution))
+	{
+		Clues = FPicrossPuzzleClues();
+	}
+}
+
+void UPicrossPuzzleData::UpdateCluesIfMissing()
+{
+	if (Clues.GridSize != GridSize || !Clues.IsValid())
+	{
+		UpdateClues();
+	}
+}
+
+float UPicrossPuzzleData::GetDifficulty() const
+{
+	return Difficulty;
+}
+
+void UPicrossPuzzleData::SetDifficulty(float NewDifficulty)
+{
+	Difficulty = NewDifficulty;
+}
+
+bool UPicrossPuzzleData::IsRated() const
+{
+	return Difficulty >= 0.f;
+}
+
+void UPicrossPuzzleData::UpdateDifficulty()
+{
+	FPicrossDifficultyRating Rating;
+	Difficulty = FPicrossDifficultyRater::Rate(*this, Rating) ? Rating.Score : -1.f;
 }
 
 bool UPicrossPuzzleData::ValidatePuzzle() const
@@ -28,7 +85,7 @@ bool UPicrossPuzzleData::ValidatePuzzle() const
 	if (GridSize.X > 0 && GridSize.Y > 0 && GridSize.Z > 0)
 	{
 		int32 Size = GridSize.X * GridSize.Y * GridSize.Z;
-		if (PicrossSolution.Num() == Size)
+		if (PackedSolution.Num() == Size)
 		{
 			return true;
 		}
@@ -44,4 +101,86 @@ FPrimaryAssetId UPicrossPuzzleData::GetPrimaryAssetId() const
 	AssetId.PrimaryAssetType = TEXT("PicrossPuzzleData");
 
 	return AssetId;
-}
\ No newline at end of file
+}
+
+void UPicrossPuzzleData::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FPicrossCustomVersion::GUID);
+	if (Ar.IsLoading() && Ar.CustomVer(FPicrossCustomVersion::GUID) < FPicrossCustomVersion::PackedSolution)
+	{
+		// Older assets stored the solution as a tagged bool array, which Super::Serialize loaded into the deprecated property.
+		PackedSolution.FromBools(PicrossSolution_DEPRECATED);
+		PicrossSolution_DEPRECATED.Empty();
+	}
+	else
+	{
+		Ar << PackedSolution;
+	}
+
+	if (Ar.IsLoading())
+	{
+		FilledCells = PackedSolution.CountFilled();
+	}
+
+	// A missing table is generated in PostLoad once rather than here, which also runs for undo and duplication.
+	bool bHasClues = Ar.IsSaving() && bSerializeClues && Clues.GridSize == GridSize;
+	if (Ar.CustomVer(FPicrossCustomVersion::GUID) >= FPicrossCustomVersion::SerializedClues)
+	{
+		Ar << bHasClues;
+		if (bHasClues)
+		{
+			Ar << Clues;
+		}
+	}
+}
+
+void UPicrossPuzzleData::PostLoad()
+{
+	Super::PostLoad();
+
+	// Only assets saved before SerializedClues or with bSerializeClues unset lack the table.
+	// Resaving the old ones stores it, with the ResavePackages commandlet for example.
+	UpdateCluesIfMissing();
+}
+
+void UPicrossPuzzleData::PostDuplicate(bool bDuplicateForPIE)
+{
+	Super::PostDuplicate(bDuplicateForPIE);
+
+	UpdateCluesIfMissing();
+}
+
+void UPicrossPuzzleData::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	// Puzzles rated in bulk beforehand are skipped, see FPicrossDifficultyRater::RateAll.
+	if (bRateOnSave && !IsRated())
+	{
+		UpdateDifficulty();
+	}
+}
+
+#if WITH_EDITOR
+void UPicrossPuzzleData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UPicrossPuzzleData, GridSize))
+	{
+		Difficulty = -1.f;
+		UpdateClues();
+	}
+}
+
+void UPicrossPuzzleData::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	// The transaction only restores the table when the asset stores it, the solution is always restored.
+	UpdateClues();
+}
+#endif
\ No newline at end of file
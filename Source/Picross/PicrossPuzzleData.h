@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "PicrossSolution.h"
+#include "Solver/PicrossPuzzleClues.h"
 #include "PicrossPuzzleData.generated.h"
 
 /**
@@ -20,15 +22,67 @@ public:
 	FIntVector GetGridSize() const;
 	void SetGridSize(FIntVector NewGridSize);
 
-	const TArray<bool>& GetSolution() const;
-	void SetSolution(const TArray<bool> Solution);
+	const FPicrossSolution& GetSolution() const;
+	void SetSolution(const TArray<bool>& Solution);
+	void SetSolution(FPicrossSolution Solution);
+
+	/**
+	 * Gets the clues of the solution, generated once whenever the solution or the size changes or loaded with the asset.
+	 * The table is empty with a zero GridSize if the puzzle isn't valid.
+	 */
+	const FPicrossPuzzleClues& GetClues() const;
+
+	float GetDifficulty() const;
+	void SetDifficulty(float NewDifficulty);
+	bool IsRated() const;
+	/**
+	 * Rates the puzzle with FPicrossDifficultyRater and stores the score.
+	 */
+	void UpdateDifficulty();
 
 	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+#endif
 	
 private:
+	void UpdateClues();
+	/**
+	 * Generates the clues unless a table for the current size was loaded with the asset.
+	 */
+	void UpdateCluesIfMissing();
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Picross", AssetRegistrySearchable, meta = (AllowPrivateAccess = "true"))
 	FIntVector GridSize;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Picross", meta = (AllowPrivateAccess = "true"))
-	TArray<bool> PicrossSolution;
+	// Score of the solver effort needed for the puzzle, negative until it has been rated.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Picross", AssetRegistrySearchable, meta = (AllowPrivateAccess = "true"))
+	float Difficulty = -1.f;
+
+	// Only loaded from assets saved before the solution was packed, see Serialize.
+	UPROPERTY()
+	TArray<bool> PicrossSolution_DEPRECATED;
+
+	// Serialized by hand in Serialize, one bit per cell.
+	FPicrossSolution PackedSolution;
+
+	// Number of filled cells in the solution, shown in the details panel as the packed solution isn't a property.
+	UPROPERTY(VisibleAnywhere, Transient, Category = "Picross", meta = (AllowPrivateAccess = "true"))
+	int32 FilledCells = 0;
+
+	// Whether to rate the puzzle when it's saved unrated. Rating solves the puzzle on the game thread, bulk rating with the RateDifficulty commandlet is preferred.
+	UPROPERTY(EditAnywhere, Category = "Picross", AdvancedDisplay)
+	bool bRateOnSave = false;
+
+	// Whether to store the clue table in the asset so loading it skips generating the clues, at the cost of the table on disk.
+	UPROPERTY(EditAnywhere, Category = "Picross", AdvancedDisplay)
+	bool bSerializeClues = true;
+
+	// Generated from PackedSolution, or serialized with it when bSerializeClues is set.
+	FPicrossPuzzleClues Clues;
 };
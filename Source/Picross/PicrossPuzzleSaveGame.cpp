@@ -3,3 +3,93 @@
 
 #include "PicrossPuzzleSaveGame.h"
 
+
+void UPicrossPuzzleSaveGame::SetStates(const TPicrossChunkedArray<EBlockState>& States)
+{
+	PicrossBlockStates.Empty();
+	NumBlocks = States.Num();
+	ChunkSize = TPicrossChunkedArray<EBlockState>::ChunkSize;
+	ChunkIndices.Reset();
+	ChunkStates.Reset();
+	for (int32 ChunkIndex = 0; ChunkIndex < States.NumChunks(); ++ChunkIndex)
+	{
+		const TArrayView<const EBlockState> Chunk = States.GetChunk(ChunkIndex);
+		if (Chunk.Num() > 0)
+		{
+			ChunkIndices.Add(ChunkIndex);
+			ChunkStates.Append(Chunk.GetData(), Chunk.Num());
+		}
+	}
+}
+
+void UPicrossPuzzleSaveGame::UpdateStates(const TPicrossChunkedArray<EBlockState>& States)
+{
+	if (PicrossBlockStates.Num() > 0 || NumBlocks != States.Num() || ChunkSize != TPicrossChunkedArray<EBlockState>::ChunkSize || ChunkStates.Num() != ChunkIndices.Num() * ChunkSize)
+	{
+		SetStates(States);
+		return;
+	}
+
+	for (int32 ChunkIndex = 0; ChunkIndex < States.NumChunks(); ++ChunkIndex)
+	{
+		if (!States.IsChunkDirty(ChunkIndex)) continue;
+
+		const TArrayView<const EBlockState> Chunk = States.GetChunk(ChunkIndex);
+		const int32 Entry = ChunkIndices.Find(ChunkIndex);
+		if (Chunk.Num() > 0)
+		{
+			if (Entry != INDEX_NONE)
+			{
+				FMemory::Memcpy(ChunkStates.GetData() + Entry * ChunkSize, Chunk.GetData(), ChunkSize * sizeof(EBlockState));
+			}
+			else
+			{
+				ChunkIndices.Add(ChunkIndex);
+				ChunkStates.Append(Chunk.GetData(), Chunk.Num());
+			}
+		}
+		else if (Entry != INDEX_NONE)
+		{
+			// The last entry takes the place of the removed one so nothing else has to move.
+			const int32 LastEntry = ChunkIndices.Num() - 1;
+			if (Entry != LastEntry)
+			{
+				FMemory::Memcpy(ChunkStates.GetData() + Entry * ChunkSize, ChunkStates.GetData() + LastEntry * ChunkSize, ChunkSize * sizeof(EBlockState));
+			}
+			ChunkIndices.RemoveAtSwap(Entry, 1, false);
+			ChunkStates.SetNum(LastEntry * ChunkSize, false);
+		}
+	}
+}
+
+bool UPicrossPuzzleSaveGame::GetStates(int32 ExpectedNumBlocks, TPicrossChunkedArray<EBlockState>& OutStates) const
+{
+	OutStates.Init(EBlockState::Clear, ExpectedNumBlocks);
+
+	if (PicrossBlockStates.Num() > 0)
+	{
+		if (PicrossBlockStates.Num() != ExpectedNumBlocks) return false;
+
+		for (int32 Index = 0; Index < PicrossBlockStates.Num(); ++Index)
+		{
+			OutStates.Set(Index, PicrossBlockStates[Index]);
+		}
+		return true;
+	}
+
+	if (NumBlocks != ExpectedNumBlocks) return false;
+	if (!ensureAlwaysMsgf(ChunkSize > 0 && ChunkStates.Num() == ChunkIndices.Num() * ChunkSize, TEXT("Corrupt save, %d chunks of %d states but %d states."), ChunkIndices.Num(), ChunkSize, ChunkStates.Num())) return false;
+
+	for (int32 Entry = 0; Entry < ChunkIndices.Num(); ++Entry)
+	{
+		const int32 Start = ChunkIndices[Entry] * ChunkSize;
+		if (!ensureAlwaysMsgf(Start >= 0 && Start < NumBlocks, TEXT("Corrupt save, chunk %d is outside of the %d blocks."), ChunkIndices[Entry], NumBlocks)) return false;
+
+		const int32 End = FMath::Min(Start + ChunkSize, NumBlocks);
+		for (int32 Index = Start; Index < End; ++Index)
+		{
+			OutStates.Set(Index, ChunkStates[Entry * ChunkSize + Index - Start]);
+		}
+	}
+	return true;
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/SaveGame.h"
 #include "PicrossBlock.h"
+#include "PicrossChunkedArray.h"
 #include "PicrossPuzzleSaveGame.generated.h"
 
 /**
@@ -17,7 +18,34 @@ class PICROSS_API UPicrossPuzzleSaveGame : public USaveGame
 	
 
 public:
+	/**
+	 * Stores the states of the chunks that have a block that isn't clear.
+	 */
+	void SetStates(const TPicrossChunkedArray<EBlockState>& States);
+	/**
+	 * Copies only the dirty chunks of States, the rest of the save is assumed to still match them.
+	 * Falls back to SetStates when the save has a different layout than States.
+	 */
+	void UpdateStates(const TPicrossChunkedArray<EBlockState>& States);
+	/**
+	 * Reads the states back from either the chunks or the full array of states older saves have.
+	 * @returns false if the save is for a different number of blocks.
+	 */
+	bool GetStates(int32 ExpectedNumBlocks, TPicrossChunkedArray<EBlockState>& OutStates) const;
+
+	// The state of every block in MasterIndex order, only written by older saves.
 	UPROPERTY(VisibleAnywhere, Category = Basic)
 	TArray<EBlockState> PicrossBlockStates;
 
+	UPROPERTY(VisibleAnywhere, Category = Basic)
+	int32 NumBlocks = 0;
+	UPROPERTY(VisibleAnywhere, Category = Basic)
+	int32 ChunkSize = 0;
+	// The chunks with a block that isn't clear in no particular order, every other block is clear.
+	UPROPERTY(VisibleAnywhere, Category = Basic)
+	TArray<int32> ChunkIndices;
+	// ChunkSize states per entry in ChunkIndices.
+	UPROPERTY(VisibleAnywhere, Category = Basic)
+	TArray<EBlockState> ChunkStates;
+
 };
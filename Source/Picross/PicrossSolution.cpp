@@ -0,0 +1,85 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossSolution.h"
+
+void FPicrossSolution::Init(int32 InNumCells, bool bFilled)
+{
+	NumCells = FMath::Max(InNumCells, 0);
+	Words.Init(bFilled ? ~uint64(0) : 0, NumWordsFor(NumCells));
+
+	// Keeps the bits past the last cell zero.
+	if (bFilled && (NumCells & 63) != 0)
+	{
+		Words.Last() = (uint64(1) << (NumCells & 63)) - 1;
+	}
+}
+
+void FPicrossSolution::Empty()
+{
+	NumCells = 0;
+	Words.Empty();
+}
+
+void FPicrossSolution::FromBools(const TArray<bool>& Cells)
+{
+	Init(Cells.Num());
+	for (int32 Index = 0; Index < Cells.Num(); ++Index)
+	{
+		Words[Index >> 6] |= uint64(Cells[Index]) << (Index & 63);
+	}
+}
+
+void FPicrossSolution::ToBools(TArray<bool>& OutCells) const
+{
+	OutCells.SetNumUninitialized(NumCells);
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		OutCells[Index] = Get(Index);
+	}
+}
+
+int32 FPicrossSolution::CountFilled() const
+{
+	int32 Count = 0;
+	for (const uint64 Word : Words)
+	{
+		Count += static_cast<int32>(FPlatformMath::CountBits(Word));
+	}
+	return Count;
+}
+
+int32 FPicrossSolution::CountDifferences(const FPicrossSolution& Other) const
+{
+	if (NumCells != Other.NumCells) return INDEX_NONE;
+
+	int32 Count = 0;
+	for (int32 WordIndex = 0; WordIndex < Words.Num(); ++WordIndex)
+	{
+		Count += static_cast<int32>(FPlatformMath::CountBits(Words[WordIndex] ^ Other.Words[WordIndex]));
+	}
+	return Count;
+}
+
+FArchive& operator<<(FArchive& Ar, FPicrossSolution& Solution)
+{
+	Ar << Solution.NumCells;
+
+	if (Ar.IsLoading())
+	{
+		// Guards against corrupt data, the words have to match the number of cells for the invariants to hold.
+		Solution.NumCells = FMath::Max(Solution.NumCells, 0);
+		Solution.Words.SetNumZeroed(FPicrossSolution::NumWordsFor(Solution.NumCells));
+	}
+
+	for (uint64& Word : Solution.Words)
+	{
+		Ar << Word;
+	}
+
+	if (Ar.IsLoading() && (Solution.NumCells & 63) != 0)
+	{
+		Solution.Words.Last() &= (uint64(1) << (Solution.NumCells & 63)) - 1;
+	}
+	return Ar;
+}
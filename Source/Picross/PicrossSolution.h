@@ -0,0 +1,59 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * The solution of a puzzle packed one bit per cell in MasterIndex order, bit I of word I / 64 is cell I.
+ * The bits past the last cell are always zero so counting and comparing work on whole 64-bit words.
+ */
+struct PICROSS_API FPicrossSolution
+{
+	FPicrossSolution() = default;
+	explicit FPicrossSolution(const TArray<bool>& Cells) { FromBools(Cells); }
+
+	/**
+	 * Resizes the solution to NumCells cells that are all filled or all empty.
+	 */
+	void Init(int32 InNumCells, bool bFilled = false);
+	void Empty();
+
+	void FromBools(const TArray<bool>& Cells);
+	void ToBools(TArray<bool>& OutCells) const;
+	TArray<bool> ToBools() const { TArray<bool> Cells; ToBools(Cells); return Cells; }
+
+	int32 Num() const { return NumCells; }
+	bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumCells; }
+
+	FORCEINLINE bool Get(int32 Index) const { checkSlow(IsValidIndex(Index)); return (Words[Index >> 6] >> (Index & 63)) & 1; }
+	FORCEINLINE void Set(int32 Index, bool bFilled)
+	{
+		checkSlow(IsValidIndex(Index));
+		const uint64 Bit = uint64(1) << (Index & 63);
+		Words[Index >> 6] = bFilled ? Words[Index >> 6] | Bit : Words[Index >> 6] & ~Bit;
+	}
+	FORCEINLINE bool operator[](int32 Index) const { return Get(Index); }
+
+	/**
+	 * Counts the filled cells a word at a time.
+	 */
+	int32 CountFilled() const;
+	/**
+	 * Counts the cells whose state differs from Other a word at a time.
+	 * @returns INDEX_NONE if the solutions don't have the same number of cells.
+	 */
+	int32 CountDifferences(const FPicrossSolution& Other) const;
+
+	TArrayView<const uint64> GetWords() const { return Words; }
+	static int32 NumWordsFor(int32 InNumCells) { return (InNumCells + 63) / 64; }
+
+	bool operator==(const FPicrossSolution& Other) const { return NumCells == Other.NumCells && Words == Other.Words; }
+	bool operator!=(const FPicrossSolution& Other) const { return !(*this == Other); }
+
+	friend PICROSS_API FArchive& operator<<(FArchive& Ar, FPicrossSolution& Solution);
+
+private:
+	int32 NumCells = 0;
+	TArray<uint64> Words;
+};
@@ -0,0 +1,97 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossDifficultyRater.h"
+#include "../PicrossPuzzleData.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+
+namespace
+{
+	// Weights of the solving stages, a puzzle needing a later stage is always rated above one that doesn't.
+	constexpr float ProbingBaseScore = 20.f;
+	constexpr float ProbedCellsScore = 100.f;
+	constexpr float BranchingBaseScore = 50.f;
+	constexpr float DecisionScore = 10.f;
+
+	// Branching is bounded so a single pathological puzzle can't stall a bulk rating, by decisions so the bound doesn't depend on the machine.
+	constexpr int64 MaxBranchingDecisions = 100000;
+}
+
+FString FPicrossDifficultyRating::ToString() const
+{
+	return FString::Printf(TEXT("Score: %.1f, Sweeps: %d, Probing: %s (%lld cells), Branching: %s (%lld decisions)"),
+		Score, Sweeps, bNeedsProbing ? TEXT("yes") : TEXT("no"), ProbedCells, bNeedsBranching ? TEXT("yes") : TEXT("no"), Decisions);
+}
+
+FPicrossVerifierOptions FPicrossDifficultyRater::MakeVerifierOptions(FPicrossLineCache* Cache, bool bParallel)
+{
+	FPicrossVerifierOptions Options;
+	Options.NumWorkers = 1;
+	Options.MaxDecisions = MaxBranchingDecisions;
+	Options.bParallelRoot = bParallel;
+	Options.Cache = Cache;
+	return Options;
+}
+
+FPicrossDifficultyRating FPicrossDifficultyRater::Rate(const FPicrossPuzzleClues& Clues, bool bParallel)
+{
+	if (!Clues.IsValid()) return FPicrossDifficultyRating();
+
+	FPicrossLineCache Cache;
+	return Rate(FPicrossUniquenessVerifier::Verify(Clues, MakeVerifierOptions(&Cache, bParallel)), Clues.GridSize);
+}
+
+FPicrossDifficultyRating FPicrossDifficultyRater::Rate(const FPicrossUniquenessResult& Uniqueness, const FIntVector& GridSize)
+{
+	FPicrossDifficultyRating Rating;
+	const int32 NumCells = GridSize.X * GridSize.Y * GridSize.Z;
+	if (NumCells <= 0) return Rating;
+
+	Rating.Uniqueness = Uniqueness.Result;
+	Rating.Sweeps = Uniqueness.RootSweeps;
+	Rating.Score = static_cast<float>(Uniqueness.RootSweeps);
+
+	if (Uniqueness.ProbeStats.Rounds > 0)
+	{
+		Rating.bNeedsProbing = true;
+		Rating.ProbedCells = Uniqueness.RootProbedCells;
+		Rating.Score += ProbingBaseScore + ProbedCellsScore * Rating.ProbedCells / NumCells;
+	}
+
+	if (Uniqueness.Decisions > 0)
+	{
+		Rating.bNeedsBranching = true;
+		Rating.Decisions = Uniqueness.Decisions;
+		Rating.Score += BranchingBaseScore + DecisionScore * FMath::Log2(1.f + Uniqueness.Decisions);
+	}
+
+	return Rating;
+}
+
+bool FPicrossDifficultyRater::Rate(const UPicrossPuzzleData& PuzzleData, FPicrossDifficultyRating& OutRating, bool bParallel)
+{
+	FPicrossPuzzleClues Clues;
+	if (!Clues.Generate(PuzzleData)) return false;
+
+	OutRating = Rate(Clues, bParallel);
+	return true;
+}
+
+int32 FPicrossDifficultyRater::RateAll(TArrayView<UPicrossPuzzleData* const> Puzzles, bool bOnlyUnrated)
+{
+	FThreadSafeCounter RatedPuzzles;
+	ParallelFor(Puzzles.Num(), [&](int32 Index)
+	{
+		UPicrossPuzzleData* PuzzleData = Puzzles[Index];
+		if (!PuzzleData || (bOnlyUnrated && PuzzleData->IsRated())) return;
+
+		FPicrossDifficultyRating Rating;
+		if (Rate(*PuzzleData, Rating, false))
+		{
+			PuzzleData->SetDifficulty(Rating.Score);
+			RatedPuzzles.Increment();
+		}
+	});
+	return RatedPuzzles.GetValue();
+}
@@ -0,0 +1,63 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PicrossUniquenessVerifier.h"
+
+/**
+ * How much effort the solver needed for a puzzle and the score derived from it.
+ */
+struct PICROSS_API FPicrossDifficultyRating
+{
+	// Higher is harder, negative means the puzzle couldn't be rated.
+	float Score = -1.f;
+	// Propagation sweeps needed before propagation alone stalled or solved the puzzle.
+	int32 Sweeps = 0;
+	bool bNeedsProbing = false;
+	// Cells that were only deduced by probing.
+	int64 ProbedCells = 0;
+	bool bNeedsBranching = false;
+	int64 Decisions = 0;
+	EPicrossUniqueness Uniqueness = EPicrossUniqueness::Undetermined;
+
+	FString ToString() const;
+};
+
+/**
+ * Rates puzzles by solving them the way a player would have to, propagation first, then probing and as a last resort branching.
+ * The score only depends on the clues, never on timing, so the same puzzle always gets the same score.
+ * Branching is bounded by a number of decisions rather than seconds, a puzzle that runs out of decisions is rated at the budget on every machine.
+ */
+class PICROSS_API FPicrossDifficultyRater
+{
+public:
+	FPicrossDifficultyRater() = delete;
+
+	/**
+	 * Options for a uniqueness check whose result can be rated, a single worker and the decision budget keep the decisions the same from run to run.
+	 * @param bParallel - Whether propagation and probing may go wide, turn off when rating several puzzles at once.
+	 */
+	static FPicrossVerifierOptions MakeVerifierOptions(FPicrossLineCache* Cache = nullptr, bool bParallel = true);
+
+	/**
+	 * @param bParallel - Whether the solver may go wide, turn off when rating several puzzles at once.
+	 */
+	static FPicrossDifficultyRating Rate(const FPicrossPuzzleClues& Clues, bool bParallel = true);
+	/**
+	 * Rates a puzzle from a uniqueness check that already ran, so callers that verified the clues don't solve them again.
+	 * The score matches Rate of the clues as long as the check used MakeVerifierOptions and wasn't stopped by a time limit.
+	 */
+	static FPicrossDifficultyRating Rate(const FPicrossUniquenessResult& Uniqueness, const FIntVector& GridSize);
+	/**
+	 * @returns false if the puzzle isn't valid.
+	 */
+	static bool Rate(const UPicrossPuzzleData& PuzzleData, FPicrossDifficultyRating& OutRating, bool bParallel = true);
+
+	/**
+	 * Rates the puzzles in parallel, one puzzle per task, and stores the score in each of them.
+	 * @param bOnlyUnrated - Skips puzzles that already have a score.
+	 * @returns the number of puzzles that were rated.
+	 */
+	static int32 RateAll(TArrayView<UPicrossPuzzleData* const> Puzzles, bool bOnlyUnrated = true);
+};
@@ -0,0 +1,6 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossGridDispatch.h"
+
+FThreadSafeBool FPicrossGridDispatch::bFixedSizesEnabled(true);
@@ -0,0 +1,81 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "TFixedArray3D.h"
+
+/**
+ * Picks the index math for a puzzle once when it's set up, so the code that runs per cell works with constant dimensions.
+ * Most of the library is 5^3, 10^3 and 15^3, those get a TFixedArray3D and everything else FDynamicArray3D.
+ * Flat puzzles are common as well but solve in a fraction of the time of a cube, so they aren't worth an instantiation of every caller.
+ */
+struct PICROSS_API FPicrossGridDispatch
+{
+	/**
+	 * Calls Func with the dimensions of GridSize as a TFixedArray3D if it's one of the common sizes and as a FDynamicArray3D otherwise.
+	 * Every instantiation of Func has to return the same type.
+	 */
+	template<typename FuncType>
+	static auto Dispatch(FIntVector GridSize, FuncType&& Func)
+	{
+		if (bFixedSizesEnabled)
+		{
+			if (GridSize == FIntVector(5, 5, 5)) return Func(TFixedArray3D<5, 5, 5>());
+			if (GridSize == FIntVector(10, 10, 10)) return Func(TFixedArray3D<10, 10, 10>());
+			if (GridSize == FIntVector(15, 15, 15)) return Func(TFixedArray3D<15, 15, 15>());
+		}
+		return Func(FDynamicArray3D(GridSize));
+	}
+
+	/**
+	 * Sends every size down the generic path, for comparing the two in benchmarks.
+	 * Puzzles being set up on other threads at the same time may take either path.
+	 */
+	static void SetFixedSizesEnabled(bool bEnabled) { bFixedSizesEnabled = bEnabled; }
+	static bool AreFixedSizesEnabled() { return bFixedSizesEnabled; }
+
+private:
+	static FThreadSafeBool bFixedSizesEnabled;
+};
+
+/**
+ * FPicrossLineLayout with the dimensions from FPicrossGridDispatch and the axis known at compile time, for loops that run per cell.
+ * AxisIndex is 0, 1 and 2 for the X, Y and Z lines.
+ */
+template<typename DimensionsType, int32 AxisIndex>
+struct TPicrossLineLayout
+{
+	static_assert(AxisIndex >= 0 && AxisIndex < 3, "AxisIndex must be 0, 1 or 2.");
+
+	explicit TPicrossLineLayout(const DimensionsType& InDimensions) : Dimensions(InDimensions) {}
+
+	static constexpr EAxis::Type GetAxis() { return static_cast<EAxis::Type>(EAxis::X + AxisIndex); }
+	FORCEINLINE int32 Axis1Size() const { return AxisIndex == 0 ? Dimensions.DY : Dimensions.DX; }
+	FORCEINLINE int32 Axis2Size() const { return AxisIndex == 2 ? Dimensions.DY : Dimensions.DZ; }
+	FORCEINLINE int32 Length() const { return AxisIndex == 0 ? Dimensions.DX : AxisIndex == 1 ? Dimensions.DY : Dimensions.DZ; }
+	FORCEINLINE int32 Num() const { return Axis1Size() * Axis2Size(); }
+	/** Gets the distance in MasterIndex between two neighbouring cells of a line. */
+	FORCEINLINE int32 GetStride() const { return AxisIndex == 0 ? 1 : AxisIndex == 1 ? Dimensions.DX : Dimensions.DX * Dimensions.DY; }
+
+	FORCEINLINE FIntVector ToXYZ(int32 LineIndex, int32 Axis3) const
+	{
+		const int32 Axis1 = LineIndex % Axis1Size();
+		const int32 Axis2 = LineIndex / Axis1Size();
+		return AxisIndex == 0 ? FIntVector(Axis3, Axis1, Axis2) : AxisIndex == 1 ? FIntVector(Axis1, Axis3, Axis2) : FIntVector(Axis1, Axis2, Axis3);
+	}
+	/** Gets the MasterIndex of the first cell of a line. */
+	FORCEINLINE int32 GetLineStart(int32 LineIndex) const
+	{
+		const FIntVector XYZ = ToXYZ(LineIndex, 0);
+		return Dimensions.TranslateTo1D(XYZ.X, XYZ.Y, XYZ.Z);
+	}
+	FORCEINLINE void FromXYZ(FIntVector XYZ, int32& OutLineIndex, int32& OutAxis3) const
+	{
+		OutLineIndex = AxisIndex == 0 ? XYZ.Z * Dimensions.DY + XYZ.Y : AxisIndex == 1 ? XYZ.Z * Dimensions.DX + XYZ.X : XYZ.Y * Dimensions.DX + XYZ.X;
+		OutAxis3 = AxisIndex == 0 ? XYZ.X : AxisIndex == 1 ? XYZ.Y : XYZ.Z;
+	}
+
+	DimensionsType Dimensions;
+};
@@ -0,0 +1,316 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossGridSolver.h"
+#include "PicrossGridDispatch.h"
+#include "PicrossLineCache.h"
+#include "../PicrossBlock.h"
+#include "../PicrossPuzzleData.h"
+#include "Async/ParallelFor.h"
+#include "FArray3D.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	// Below this many dirty lines the overhead of going wide is larger than the work itself.
+	constexpr int32 MinLinesForParallelSweep = 32;
+}
+
+void FPicrossLineWorklist::Init(FIntVector GridSize)
+{
+	for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+	{
+		const int32 AxisIndex = Axis - EAxis::X;
+		Lines[AxisIndex].Reset();
+		Queued[AxisIndex].Init(false, FPicrossLineLayout(GridSize, Axis).Num());
+	}
+}
+
+void FPicrossLineWorklist::AddAll()
+{
+	for (int32 AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+	{
+		Lines[AxisIndex].Reset();
+		for (int32 LineIndex = 0; LineIndex < Queued[AxisIndex].Num(); ++LineIndex)
+		{
+			Queued[AxisIndex][LineIndex] = true;
+			Lines[AxisIndex].Add(LineIndex);
+		}
+	}
+}
+
+void FPicrossLineWorklist::Add(EAxis::Type Axis, int32 LineIndex)
+{
+	const int32 AxisIndex = Axis - EAxis::X;
+	if (!Queued[AxisIndex][LineIndex])
+	{
+		Queued[AxisIndex][LineIndex] = true;
+		Lines[AxisIndex].Add(LineIndex);
+	}
+}
+
+void FPicrossLineWorklist::Reset()
+{
+	for (int32 AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+	{
+		for (const int32 LineIndex : Lines[AxisIndex])
+		{
+			Queued[AxisIndex][LineIndex] = false;
+		}
+		Lines[AxisIndex].Reset();
+	}
+}
+
+void FPicrossLineWorklist::Pop(EAxis::Type Axis, TArray<int32>& OutLines)
+{
+	const int32 AxisIndex = Axis - EAxis::X;
+	OutLines = MoveTemp(Lines[AxisIndex]);
+	Lines[AxisIndex].Reset();
+	for (const int32 LineIndex : OutLines)
+	{
+		Queued[AxisIndex][LineIndex] = false;
+	}
+}
+
+void FPicrossSolverGrid::Init(FIntVector InGridSize)
+{
+	GridSize = InGridSize;
+	for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+	{
+		const int32 AxisIndex = Axis - EAxis::X;
+		Layouts[AxisIndex] = FPicrossLineLayout(GridSize, Axis);
+		Lines[AxisIndex].Reset();
+		Lines[AxisIndex].SetNum(Layouts[AxisIndex].Num());
+	}
+
+	FPicrossGridDispatch::Dispatch(GridSize, [this](auto Dimensions)
+	{
+		typedef decltype(Dimensions) DimensionsType;
+		ScatterCellsFunctions[0] = &FPicrossSolverGrid::ScatterCells<DimensionsType, 0>;
+		ScatterCellsFunctions[1] = &FPicrossSolverGrid::ScatterCells<DimensionsType, 1>;
+		ScatterCellsFunctions[2] = &FPicrossSolverGrid::ScatterCells<DimensionsType, 2>;
+	});
+}
+
+EBlockState FPicrossSolverGrid::GetCell(FIntVector XYZ) const
+{
+	const FPicrossLineState& Line = Lines[0][Layouts[0].GetLineIndex(XYZ.Y, XYZ.Z)];
+	return Line.Filled.Get(XYZ.X) ? EBlockState::Filled : Line.Empty.Get(XYZ.X) ? EBlockState::Crossed : EBlockState::Clear;
+}
+
+bool FPicrossSolverGrid::SetCell(FIntVector XYZ, bool bFilled, FPicrossLineWorklist* Worklist)
+{
+	const EBlockState Current = GetCell(XYZ);
+	if (Current != EBlockState::Clear) return Current == (bFilled ? EBlockState::Filled : EBlockState::Crossed);
+
+	for (int32 AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+	{
+		int32 LineIndex, Axis3;
+		Layouts[AxisIndex].FromXYZ(XYZ, LineIndex, Axis3);
+		FPicrossLineState& Line = Lines[AxisIndex][LineIndex];
+		(bFilled ? Line.Filled : Line.Empty).Set(Axis3);
+
+		if (Worklist)
+		{
+			Worklist->Add(Layouts[AxisIndex].Axis, LineIndex);
+		}
+	}
+	return true;
+}
+
+void FPicrossSolverGrid::ApplyLine(EAxis::Type Axis, int32 LineIndex, const FPicrossLineState& NewLine, FPicrossLineWorklist* Worklist)
+{
+	const int32 AxisIndex = Axis - EAxis::X;
+	FPicrossLineState& Line = Lines[AxisIndex][LineIndex];
+	const FPicrossLineMask NewlyFilled = NewLine.Filled & ~Line.Filled;
+	const FPicrossLineMask NewlyEmpty = NewLine.Empty & ~Line.Empty;
+	Line = NewLine;
+
+	// Only the changed cells are scattered to the crossing lines, the line itself is already up to date.
+	(this->*ScatterCellsFunctions[AxisIndex])(LineIndex, NewlyFilled, NewlyEmpty, Worklist);
+}
+
+template<typename DimensionsType, int32 AxisIndex>
+void FPicrossSolverGrid::ScatterCells(int32 LineIndex, const FPicrossLineMask& NewlyFilled, const FPicrossLineMask& NewlyEmpty, FPicrossLineWorklist* Worklist)
+{
+	constexpr int32 OtherAxisIndex1 = AxisIndex == 0 ? 1 : 0;
+	constexpr int32 OtherAxisIndex2 = AxisIndex == 2 ? 1 : 2;
+	const DimensionsType Dimensions(GridSize);
+	const TPicrossLineLayout<DimensionsType, AxisIndex> Layout(Dimensions);
+	const TPicrossLineLayout<DimensionsType, OtherAxisIndex1> OtherLayout1(Dimensions);
+	const TPicrossLineLayout<DimensionsType, OtherAxisIndex2> OtherLayout2(Dimensions);
+
+	// Only the coordinate along the line changes between its cells.
+	FIntVector XYZ = Layout.ToXYZ(LineIndex, 0);
+	for (const bool bFilled : { true, false })
+	{
+		const FPicrossLineMask& Changed = bFilled ? NewlyFilled : NewlyEmpty;
+		for (int32 Axis3 = Changed.FindFirstSetBit(0, Layout.Length()); Axis3 != INDEX_NONE; Axis3 = Changed.FindFirstSetBit(Axis3 + 1, Layout.Length()))
+		{
+			XYZ[AxisIndex] = Axis3;
+
+			int32 OtherLineIndex, OtherAxis3;
+			OtherLayout1.FromXYZ(XYZ, OtherLineIndex, OtherAxis3);
+			FPicrossLineState& OtherLine1 = Lines[OtherAxisIndex1][OtherLineIndex];
+			(bFilled ? OtherLine1.Filled : OtherLine1.Empty).Set(OtherAxis3);
+			if (Worklist)
+			{
+				Worklist->Add(OtherLayout1.GetAxis(), OtherLineIndex);
+			}
+
+			OtherLayout2.FromXYZ(XYZ, OtherLineIndex, OtherAxis3);
+			FPicrossLineState& OtherLine2 = Lines[OtherAxisIndex2][OtherLineIndex];
+			(bFilled ? OtherLine2.Filled : OtherLine2.Empty).Set(OtherAxis3);
+			if (Worklist)
+			{
+				Worklist->Add(OtherLayout2.GetAxis(), OtherLineIndex);
+			}
+		}
+	}
+}
+
+int32 FPicrossSolverGrid::CountKnownCells() const
+{
+	int32 Count = 0;
+	for (const FPicrossLineState& Line : Lines[0])
+	{
+		Count += Line.Filled.CountSetBits() + Line.Empty.CountSetBits();
+	}
+	return Count;
+}
+
+void FPicrossSolverGrid::ToBlockStates(TArray<EBlockState>& OutStates) const
+{
+	OutStates.SetNumUninitialized(Num());
+	for (int32 Z = 0; Z < GridSize.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < GridSize.Y; ++Y)
+		{
+			const FPicrossLineState& Line = Lines[0][Layouts[0].GetLineIndex(Y, Z)];
+			const int32 RowStart = FArray3D::TranslateTo1D(GridSize, 0, Y, Z);
+			for (int32 X = 0; X < GridSize.X; ++X)
+			{
+				OutStates[RowStart + X] = Line.Filled.Get(X) ? EBlockState::Filled : Line.Empty.Get(X) ? EBlockState::Crossed : EBlockState::Clear;
+			}
+		}
+	}
+}
+
+FPicrossSolverStats& FPicrossSolverStats::operator+=(const FPicrossSolverStats& Other)
+{
+	Sweeps += Other.Sweeps;
+	LinesProcessed += Other.LinesProcessed;
+	LinesChanged += Other.LinesChanged;
+	LinesSkipped += Other.LinesSkipped;
+	for (int32 AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+	{
+		AxisSeconds[AxisIndex] += Other.AxisSeconds[AxisIndex];
+	}
+	TotalSeconds += Other.TotalSeconds;
+	return *this;
+}
+
+FString FPicrossSolverStats::ToString() const
+{
+	return FString::Printf(TEXT("Sweeps: %d, Lines processed: %lld, changed: %lld, skipped: %lld, Time X: %.3fms Y: %.3fms Z: %.3fms Total: %.3fms"),
+		Sweeps, LinesProcessed, LinesChanged, LinesSkipped, AxisSeconds[0] * 1000.0, AxisSeconds[1] * 1000.0, AxisSeconds[2] * 1000.0, TotalSeconds * 1000.0);
+}
+
+FPicrossGridSolver::FPicrossGridSolver(const FPicrossPuzzleClues& InClues)
+	: Clues(InClues)
+{
+}
+
+void FPicrossGridSolver::InitGrid(FPicrossSolverGrid& OutGrid) const
+{
+	OutGrid.Init(Clues.GridSize);
+}
+
+EPicrossSolveResult FPicrossGridSolver::Propagate(FPicrossSolverGrid& Grid, FPicrossSolverStats* Stats) const
+{
+	FPicrossLineWorklist Worklist;
+	Worklist.Init(Grid.GetGridSize());
+	Worklist.AddAll();
+	return Propagate(Grid, Worklist, Stats);
+}
+
+EPicrossSolveResult FPicrossGridSolver::Propagate(FPicrossSolverGrid& Grid, FPicrossLineWorklist& Worklist, FPicrossSolverStats* Stats) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FPicrossSolverStats LocalStats;
+
+	TArray<int32> DirtyLines;
+	TArray<FPicrossLineState> SolvedLines;
+	TArray<EPicrossLineResult> Results;
+	bool bContradiction = false;
+
+	while (!Worklist.IsEmpty() && !bContradiction)
+	{
+		++LocalStats.Sweeps;
+		for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+		{
+			const double AxisStartTime = FPlatformTime::Seconds();
+			const FPicrossLineLayout& Layout = Grid.GetLayout(Axis);
+
+			Worklist.Pop(Axis, DirtyLines);
+			LocalStats.LinesProcessed += DirtyLines.Num();
+			LocalStats.LinesSkipped += Layout.Num() - DirtyLines.Num();
+			if (DirtyLines.Num() == 0) continue;
+
+			// Lines along the same axis share no cells, so they can be solved independently and merged afterwards.
+			SolvedLines.SetNumUninitialized(DirtyLines.Num());
+			Results.SetNumUninitialized(DirtyLines.Num());
+			ParallelFor(DirtyLines.Num(), [&](int32 Index)
+			{
+				SolvedLines[Index] = Grid.GetLine(Axis, DirtyLines[Index]);
+				const TArrayView<const uint16> Clue = Clues.GetClue(Axis, DirtyLines[Index]);
+				Results[Index] = Cache ? Cache->Solve(Clue, Layout.Length, SolvedLines[Index]) : FPicrossLineSolver::Solve(Clue, Layout.Length, SolvedLines[Index]);
+			}, !bParallel || DirtyLines.Num() < MinLinesForParallelSweep);
+
+			for (int32 Index = 0; Index < DirtyLines.Num(); ++Index)
+			{
+				if (Results[Index] == EPicrossLineResult::Contradiction)
+				{
+					bContradiction = true;
+					break;
+				}
+				if (Results[Index] == EPicrossLineResult::Changed)
+				{
+					++LocalStats.LinesChanged;
+					Grid.ApplyLine(Axis, DirtyLines[Index], SolvedLines[Index], &Worklist);
+				}
+			}
+
+			LocalStats.AxisSeconds[Axis - EAxis::X] += FPlatformTime::Seconds() - AxisStartTime;
+			if (bContradiction) break;
+		}
+	}
+
+	LocalStats.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	if (Stats)
+	{
+		*Stats += LocalStats;
+	}
+
+	if (bContradiction)
+	{
+		Worklist.Reset();
+		return EPicrossSolveResult::Contradiction;
+	}
+	return Grid.IsSolved() ? EPicrossSolveResult::Solved : EPicrossSolveResult::Stalled;
+}
+
+bool FPicrossGridSolver::Solve(const UPicrossPuzzleData& PuzzleData, FPicrossSolverOutput& OutOutput)
+{
+	FPicrossPuzzleClues PuzzleClues;
+	if (!PuzzleClues.Generate(PuzzleData)) return false;
+
+	const FPicrossGridSolver Solver(PuzzleClues);
+	FPicrossSolverGrid Grid;
+	Solver.InitGrid(Grid);
+
+	OutOutput.Stats = FPicrossSolverStats();
+	OutOutput.Result = Solver.Propagate(Grid, &OutOutput.Stats);
+	Grid.ToBlockStates(OutOutput.Grid);
+	return true;
+}
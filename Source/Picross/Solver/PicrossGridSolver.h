@@ -0,0 +1,163 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PicrossLineSolver.h"
+
+// Forward declarations
+enum class EBlockState : uint8;
+class FPicrossLineCache;
+class UPicrossPuzzleData;
+
+/**
+ * Set of lines that need to be (re)solved, each line is only queued once.
+ */
+struct PICROSS_API FPicrossLineWorklist
+{
+	void Init(FIntVector GridSize);
+	void AddAll();
+	void Add(EAxis::Type Axis, int32 LineIndex);
+	void Reset();
+	bool IsEmpty() const { return Lines[0].Num() == 0 && Lines[1].Num() == 0 && Lines[2].Num() == 0; }
+
+	/**
+	 * Moves the queued lines of an axis into OutLines, leaving the axis empty.
+	 */
+	void Pop(EAxis::Type Axis, TArray<int32>& OutLines);
+
+private:
+	TArray<int32> Lines[3];
+	TArray<bool> Queued[3];
+};
+
+/**
+ * The known cells of a whole puzzle.
+ * Every cell is stored once per axis as line masks so any line can be handed to the line solver without gathering its cells.
+ */
+struct PICROSS_API FPicrossSolverGrid
+{
+	void Init(FIntVector InGridSize);
+
+	FIntVector GetGridSize() const { return GridSize; }
+	const FPicrossLineLayout& GetLayout(EAxis::Type Axis) const { return Layouts[Axis - EAxis::X]; }
+	const FPicrossLineState& GetLine(EAxis::Type Axis, int32 LineIndex) const { return Lines[Axis - EAxis::X][LineIndex]; }
+
+	/**
+	 * @returns Clear for unknown cells, Crossed for cells known to be empty and Filled for cells known to be filled.
+	 */
+	EBlockState GetCell(FIntVector XYZ) const;
+	/**
+	 * Marks a cell as known, queuing the lines passing through it if it changed.
+	 * @returns false if the cell is already known to be the opposite state.
+	 */
+	bool SetCell(FIntVector XYZ, bool bFilled, FPicrossLineWorklist* Worklist = nullptr);
+	/**
+	 * Replaces a line with a solved version of it, copying the changed cells to the crossing lines of the other axes and queuing them.
+	 */
+	void ApplyLine(EAxis::Type Axis, int32 LineIndex, const FPicrossLineState& NewLine, FPicrossLineWorklist* Worklist = nullptr);
+
+	int32 Num() const { return GridSize.X * GridSize.Y * GridSize.Z; }
+	int32 CountKnownCells() const;
+	bool IsSolved() const { return CountKnownCells() == Num(); }
+
+	/**
+	 * Writes the state of every cell in MasterIndex order.
+	 */
+	void ToBlockStates(TArray<EBlockState>& OutStates) const;
+
+private:
+	/**
+	 * The part of ApplyLine that runs per changed cell, instantiated per axis and for the dimensions picked by FPicrossGridDispatch.
+	 */
+	template<typename DimensionsType, int32 AxisIndex>
+	void ScatterCells(int32 LineIndex, const FPicrossLineMask& NewlyFilled, const FPicrossLineMask& NewlyEmpty, FPicrossLineWorklist* Worklist);
+	typedef void (FPicrossSolverGrid::*FScatterCellsFunction)(int32, const FPicrossLineMask&, const FPicrossLineMask&, FPicrossLineWorklist*);
+
+	FIntVector GridSize = FIntVector::ZeroValue;
+	FPicrossLineLayout Layouts[3];
+	TArray<FPicrossLineState> Lines[3];
+	// Picked once in Init for the grid size.
+	FScatterCellsFunction ScatterCellsFunctions[3] = { nullptr, nullptr, nullptr };
+};
+
+enum class EPicrossSolveResult : uint8
+{
+	// Every cell was deduced.
+	Solved,
+	// Nothing more can be deduced but some cells are still unknown.
+	Stalled,
+	// The known cells don't fit the clues.
+	Contradiction
+};
+
+/**
+ * Statistics gathered while solving, used for profiling the solver and rating puzzles.
+ */
+struct PICROSS_API FPicrossSolverStats
+{
+	int32 Sweeps = 0;
+	int64 LinesProcessed = 0;
+	int64 LinesChanged = 0;
+	int64 LinesSkipped = 0;
+	double AxisSeconds[3] = { 0.0, 0.0, 0.0 };
+	double TotalSeconds = 0.0;
+
+	FPicrossSolverStats& operator+=(const FPicrossSolverStats& Other);
+	FString ToString() const;
+};
+
+/**
+ * The result of solving a puzzle headless.
+ */
+struct PICROSS_API FPicrossSolverOutput
+{
+	EPicrossSolveResult Result = EPicrossSolveResult::Contradiction;
+	// The state of every cell in MasterIndex order, Clear for cells that couldn't be deduced.
+	TArray<EBlockState> Grid;
+	FPicrossSolverStats Stats;
+};
+
+/**
+ * Whole-grid constraint propagation.
+ * Sweeps the X, Y & Z lines with the line solver until nothing changes, only revisiting lines whose cells changed.
+ */
+class PICROSS_API FPicrossGridSolver
+{
+public:
+	explicit FPicrossGridSolver(const FPicrossPuzzleClues& InClues);
+
+	const FPicrossPuzzleClues& GetClues() const { return Clues; }
+	void SetParallel(bool bInParallel) { bParallel = bInParallel; }
+	/**
+	 * @param InCache - Optional cache of solved lines, it has to outlive the solver and can be shared between solvers on any thread.
+	 */
+	void SetCache(FPicrossLineCache* InCache) { Cache = InCache; }
+	FPicrossLineCache* GetCache() const { return Cache; }
+
+	/**
+	 * Creates an empty grid with the size of the puzzle.
+	 */
+	void InitGrid(FPicrossSolverGrid& OutGrid) const;
+
+	/**
+	 * Propagates every line of the grid.
+	 */
+	EPicrossSolveResult Propagate(FPicrossSolverGrid& Grid, FPicrossSolverStats* Stats = nullptr) const;
+	/**
+	 * Propagates starting from the queued lines, queuing crossing lines as cells change until the worklist is empty.
+	 * The worklist is also emptied when a contradiction is found so it can be reused.
+	 */
+	EPicrossSolveResult Propagate(FPicrossSolverGrid& Grid, FPicrossLineWorklist& Worklist, FPicrossSolverStats* Stats = nullptr) const;
+
+	/**
+	 * Solves a puzzle from its clues alone by propagation.
+	 * @returns false if the puzzle isn't valid.
+	 */
+	static bool Solve(const UPicrossPuzzleData& PuzzleData, FPicrossSolverOutput& OutOutput);
+
+private:
+	const FPicrossPuzzleClues& Clues;
+	FPicrossLineCache* Cache = nullptr;
+	bool bParallel = true;
+};
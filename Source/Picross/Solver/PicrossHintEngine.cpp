@@ -0,0 +1,198 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossHintEngine.h"
+#include "PicrossProber.h"
+#include "../PicrossBlock.h"
+#include "../PicrossPuzzleData.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "FArray3D.h"
+
+namespace
+{
+	// How many lines are solved between checks of the cancel flag.
+	constexpr int32 LinesPerCancelCheck = 64;
+
+	void AddCell(FPicrossHint& Hint, int32 MasterIndex, EBlockState State)
+	{
+		if (Hint.Cells.Num() < FPicrossHint::MaxCells)
+		{
+			Hint.Cells.Add({ MasterIndex, State });
+		}
+	}
+
+	bool FindMistakes(const FPicrossSolution& Solution, const TArray<EBlockState>& States, FPicrossHint& OutHint)
+	{
+		for (int32 Index = 0; Index < States.Num() && OutHint.Cells.Num() < FPicrossHint::MaxCells; ++Index)
+		{
+			if ((States[Index] == EBlockState::Filled && !Solution[Index]) || (States[Index] == EBlockState::Crossed && Solution[Index]))
+			{
+				AddCell(OutHint, Index, States[Index]);
+			}
+		}
+
+		if (OutHint.Cells.Num() == 0) return false;
+		OutHint.Type = EPicrossHintType::Mistake;
+		return true;
+	}
+
+	/**
+	 * Finds the line where a single pass of the line solver deduces the most cells, the step a player would most likely see next.
+	 */
+	bool FindLineHint(const FPicrossPuzzleClues& Clues, const FPicrossSolverGrid& Grid, const FThreadSafeBool& CancelFlag, FPicrossHint& OutHint)
+	{
+		int32 BestCount = 0;
+		FPicrossLineState BestLine;
+		for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+		{
+			const FPicrossLineLayout& Layout = Grid.GetLayout(Axis);
+			for (int32 LineIndex = 0; LineIndex < Layout.Num(); ++LineIndex)
+			{
+				if (LineIndex % LinesPerCancelCheck == 0 && CancelFlag) return false;
+
+				const FPicrossLineState& Line = Grid.GetLine(Axis, LineIndex);
+				FPicrossLineState NewLine = Line;
+				if (FPicrossLineSolver::Solve(Clues.GetClue(Axis, LineIndex), Layout.Length, NewLine) != EPicrossLineResult::Changed) continue;
+
+				const int32 Count = (NewLine.Filled & ~Line.Filled).CountSetBits() + (NewLine.Empty & ~Line.Empty).CountSetBits();
+				if (Count > BestCount)
+				{
+					BestCount = Count;
+					BestLine = NewLine;
+					OutHint.Axis = Axis;
+					OutHint.LineIndex = LineIndex;
+				}
+			}
+		}
+
+		if (BestCount == 0) return false;
+
+		const FPicrossLineLayout& Layout = Grid.GetLayout(OutHint.Axis);
+		const FPicrossLineState& Line = Grid.GetLine(OutHint.Axis, OutHint.LineIndex);
+		for (int32 Axis3 = 0; Axis3 < Layout.Length; ++Axis3)
+		{
+			const bool bNewlyFilled = BestLine.Filled.Get(Axis3) && !Line.Filled.Get(Axis3);
+			const bool bNewlyEmpty = BestLine.Empty.Get(Axis3) && !Line.Empty.Get(Axis3);
+			if (bNewlyFilled || bNewlyEmpty)
+			{
+				AddCell(OutHint, FArray3D::TranslateTo1D(Grid.GetGridSize(), Layout.ToXYZ(OutHint.LineIndex, Axis3)), bNewlyFilled ? EBlockState::Filled : EBlockState::Crossed);
+			}
+		}
+		OutHint.Type = EPicrossHintType::Line;
+		return true;
+	}
+
+	bool FindProbeHint(const FPicrossPuzzleClues& Clues, const FPicrossSolverGrid& Grid, const FThreadSafeBool& CancelFlag, FPicrossHint& OutHint)
+	{
+		// The hint search shares the task graph with the game, so it stays on its own thread instead of going wide.
+		FPicrossGridSolver Solver(Clues);
+		Solver.SetParallel(false);
+		FPicrossProber Prober(Solver);
+		Prober.SetParallel(false);
+
+		FPicrossSolverGrid ProbedGrid = Grid;
+		Prober.Solve(ProbedGrid, nullptr, &CancelFlag);
+		if (CancelFlag) return false;
+
+		TArray<EBlockState> Before, After;
+		Grid.ToBlockStates(Before);
+		ProbedGrid.ToBlockStates(After);
+		for (int32 Index = 0; Index < Before.Num() && OutHint.Cells.Num() < FPicrossHint::MaxCells; ++Index)
+		{
+			if (Before[Index] != After[Index])
+			{
+				AddCell(OutHint, Index, After[Index]);
+			}
+		}
+
+		if (OutHint.Cells.Num() == 0) return false;
+		OutHint.Type = EPicrossHintType::Probe;
+		return true;
+	}
+}
+
+FPicrossHintEngine::~FPicrossHintEngine()
+{
+	Cancel();
+}
+
+bool FPicrossHintEngine::SetPuzzle(const UPicrossPuzzleData& PuzzleData)
+{
+	Cancel();
+	Clues.Reset();
+	Solution.Reset();
+
+	TSharedPtr<FPicrossPuzzleClues, ESPMode::ThreadSafe> NewClues = MakeShared<FPicrossPuzzleClues, ESPMode::ThreadSafe>();
+	if (!NewClues->Generate(PuzzleData)) return false;
+
+	Clues = NewClues;
+	Solution = MakeShared<FPicrossSolution, ESPMode::ThreadSafe>(PuzzleData.GetSolution());
+	return true;
+}
+
+void FPicrossHintEngine::Request(TPicrossChunkedArray<EBlockState>&& States, FOnHintFound OnHintFound)
+{
+	Cancel();
+	if (!Clues.IsValid() || States.Num() != Solution->Num()) return;
+
+	CancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+	FFunctionGraphTask::CreateAndDispatchWhenReady([Clues = Clues, Solution = Solution, States = MoveTemp(States), CancelFlag = CancelFlag, OnHintFound = MoveTemp(OnHintFound)]()
+	{
+		TArray<EBlockState> UnpackedStates;
+		States.ToArray(UnpackedStates);
+		FPicrossHint Hint = FindHint(*Clues, *Solution, UnpackedStates, *CancelFlag);
+		if (*CancelFlag) return;
+
+		// Cancelling happens on the game thread as well, so checking the flag there guarantees a stale hint is never shown.
+		AsyncTask(ENamedThreads::GameThread, [CancelFlag, Hint = MoveTemp(Hint), OnHintFound]()
+		{
+			if (!*CancelFlag)
+			{
+				OnHintFound.ExecuteIfBound(Hint);
+			}
+		});
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+void FPicrossHintEngine::Cancel()
+{
+	if (CancelFlag.IsValid())
+	{
+		*CancelFlag = true;
+		CancelFlag.Reset();
+	}
+}
+
+FPicrossHint FPicrossHintEngine::FindHint(const FPicrossPuzzleClues& Clues, const FPicrossSolution& Solution, const TArray<EBlockState>& States, const FThreadSafeBool& CancelFlag)
+{
+	FPicrossHint Hint;
+	if (States.Num() != Solution.Num() || FindMistakes(Solution, States, Hint)) return Hint;
+
+	// Without mistakes every mark agrees with the solution, so the grid can't contradict the clues.
+	TArray<int32> MarkedIndices;
+	for (int32 Index = 0; Index < States.Num(); ++Index)
+	{
+		if (States[Index] != EBlockState::Clear)
+		{
+			MarkedIndices.Add(Index);
+		}
+	}
+	TArray<FIntVector> MarkedCells;
+	MarkedCells.SetNumUninitialized(MarkedIndices.Num());
+	if (!FArray3D::TranslateTo3D(Clues.GridSize, MarkedIndices, MarkedCells)) return Hint;
+
+	FPicrossSolverGrid Grid;
+	Grid.Init(Clues.GridSize);
+	for (int32 Index = 0; Index < MarkedIndices.Num(); ++Index)
+	{
+		Grid.SetCell(MarkedCells[Index], States[MarkedIndices[Index]] == EBlockState::Filled);
+	}
+
+	if (Grid.IsSolved() || FindLineHint(Clues, Grid, CancelFlag, Hint)) return Hint;
+	if (!CancelFlag)
+	{
+		FindProbeHint(Clues, Grid, CancelFlag, Hint);
+	}
+	return Hint;
+}
@@ -0,0 +1,84 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "PicrossLineSolver.h"
+#include "../PicrossChunkedArray.h"
+#include "../PicrossSolution.h"
+
+// Forward declarations
+enum class EBlockState : uint8;
+class UPicrossPuzzleData;
+
+enum class EPicrossHintType : uint8
+{
+	// Nothing left to deduce.
+	None,
+	// Cells the player marked wrong.
+	Mistake,
+	// Cells a single line deduces on its own.
+	Line,
+	// Cells only found by trying both values of a cell.
+	Probe
+};
+
+struct PICROSS_API FPicrossHintCell
+{
+	int32 MasterIndex;
+	// Filled or Crossed for deduced cells, the wrong mark for mistakes.
+	EBlockState State;
+};
+
+/**
+ * The next step the player can take, kept small so it's cheap to hand back to the game thread.
+ */
+struct PICROSS_API FPicrossHint
+{
+	static constexpr int32 MaxCells = 16;
+
+	EPicrossHintType Type = EPicrossHintType::None;
+	// The line the cells were deduced from for Line hints.
+	EAxis::Type Axis = EAxis::None;
+	int32 LineIndex = INDEX_NONE;
+	TArray<FPicrossHintCell, TInlineAllocator<MaxCells>> Cells;
+};
+
+/**
+ * Finds hints on a background thread of the task graph.
+ * Only one search runs at a time, a new request cancels the previous one and a cancelled search never reports back.
+ */
+class PICROSS_API FPicrossHintEngine
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnHintFound, const FPicrossHint&);
+
+	~FPicrossHintEngine();
+
+	/**
+	 * Generates the clues of the puzzle, cancelling any search for the previous puzzle.
+	 * @returns false if the puzzle isn't valid.
+	 */
+	bool SetPuzzle(const UPicrossPuzzleData& PuzzleData);
+
+	/**
+	 * Starts searching for a hint for the given player grid.
+	 * @param States - The state of every block in MasterIndex order, moved into the search which unpacks it on its own thread so the caller only pays for copying the touched chunks.
+	 * @param OnHintFound - Called on the game thread once the hint is found, unless the search is cancelled first.
+	 */
+	void Request(TPicrossChunkedArray<EBlockState>&& States, FOnHintFound OnHintFound);
+	void Cancel();
+
+	/**
+	 * Finds a hint on the calling thread.
+	 * Mistakes come first, then the line that deduces the most cells and only when no line deduces anything a probe.
+	 */
+	static FPicrossHint FindHint(const FPicrossPuzzleClues& Clues, const FPicrossSolution& Solution, const TArray<EBlockState>& States, const FThreadSafeBool& CancelFlag);
+
+private:
+	// Shared with the running search so the engine can go away before the search notices it was cancelled.
+	TSharedPtr<const FPicrossPuzzleClues, ESPMode::ThreadSafe> Clues;
+	TSharedPtr<const FPicrossSolution, ESPMode::ThreadSafe> Solution;
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+};
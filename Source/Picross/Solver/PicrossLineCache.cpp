@@ -0,0 +1,124 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossLineCache.h"
+#include "Hash/CityHash.h"
+
+namespace
+{
+	int32 NumWordsForLength(int32 Length)
+	{
+		return (Length + 63) / 64;
+	}
+}
+
+FString FPicrossLineCacheStats::ToString() const
+{
+	return FString::Printf(TEXT("Hits: %lld, Misses: %lld, Hit rate: %.1f%%, Evictions: %lld, Entries: %d, Memory: %.2fMB"),
+		Hits, Misses, GetHitRate() * 100.0, Evictions, Entries, AllocatedBytes / (1024.0 * 1024.0));
+}
+
+bool FPicrossLineCache::FEntry::Matches(TArrayView<const uint16> InClue, int32 InLength, const FPicrossLineState& InLine) const
+{
+	return Length == InLength && Line == InLine && Clue.Num() == InClue.Num() && (InClue.Num() == 0 || FMemory::Memcmp(Clue.GetData(), InClue.GetData(), InClue.Num() * sizeof(uint16)) == 0);
+}
+
+FPicrossLineCache::FPicrossLineCache(SIZE_T MaxBytes)
+{
+	// Rough cost of one entry, the map element with its hash bookkeeping and the slot in the insertion order.
+	const SIZE_T BytesPerEntry = sizeof(TPair<uint64, FEntry>) + sizeof(uint64) * 3;
+	MaxEntriesPerShard = FMath::Max<int32>(static_cast<int32>(FMath::Min<SIZE_T>(MaxBytes / (BytesPerEntry * NumShards), MAX_int32)), 1);
+}
+
+uint64 FPicrossLineCache::HashLine(TArrayView<const uint16> Clue, int32 Length, const FPicrossLineState& Line)
+{
+	// Only the words that can hold cells of the line are hashed, the rest are always zero.
+	const uint32 MaskBytes = NumWordsForLength(Length) * sizeof(uint64);
+	uint64 Hash = CityHash64(reinterpret_cast<const char*>(Clue.GetData()), Clue.Num() * sizeof(uint16));
+	Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Line.Filled.Words), MaskBytes, Hash ^ uint64(Length));
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Line.Empty.Words), MaskBytes, Hash);
+}
+
+EPicrossLineResult FPicrossLineCache::Solve(TArrayView<const uint16> Clue, int32 Length, FPicrossLineState& InOutLine)
+{
+	const uint64 Hash = HashLine(Clue, Length, InOutLine);
+	// The top bits pick the shard so the low bits the map buckets on stay independent of it.
+	FShard& Shard = Shards[Hash >> 58];
+	static_assert(NumShards == 64, "The shard index is taken from the top 6 bits of the hash.");
+
+	{
+		FRWScopeLock ReadLock(Shard.Lock, SLT_ReadOnly);
+		if (const FEntry* Entry = Shard.Entries.Find(Hash))
+		{
+			if (Entry->Matches(Clue, Length, InOutLine))
+			{
+				Hits.Increment();
+				InOutLine = Entry->Solution;
+				return Entry->Result;
+			}
+		}
+	}
+
+	Misses.Increment();
+	FEntry NewEntry;
+	NewEntry.Clue.Append(Clue.GetData(), Clue.Num());
+	NewEntry.Length = Length;
+	NewEntry.Line = InOutLine;
+	const EPicrossLineResult Result = FPicrossLineSolver::Solve(Clue, Length, InOutLine);
+	NewEntry.Solution = InOutLine;
+	NewEntry.Result = Result;
+
+	FRWScopeLock WriteLock(Shard.Lock, SLT_Write);
+	if (FEntry* Existing = Shard.Entries.Find(Hash))
+	{
+		// Either another thread solved the same line meanwhile or the hashes collide, the newest entry wins.
+		*Existing = MoveTemp(NewEntry);
+	}
+	else if (Shard.Entries.Num() < MaxEntriesPerShard)
+	{
+		Shard.Entries.Add(Hash, MoveTemp(NewEntry));
+		Shard.InsertionOrder.Add(Hash);
+	}
+	else
+	{
+		Shard.Entries.Remove(Shard.InsertionOrder[Shard.NextEviction]);
+		Shard.Entries.Add(Hash, MoveTemp(NewEntry));
+		Shard.InsertionOrder[Shard.NextEviction] = Hash;
+		Shard.NextEviction = (Shard.NextEviction + 1) % Shard.InsertionOrder.Num();
+		Evictions.Increment();
+	}
+	return Result;
+}
+
+void FPicrossLineCache::Empty()
+{
+	for (FShard& Shard : Shards)
+	{
+		FRWScopeLock WriteLock(Shard.Lock, SLT_Write);
+		Shard.Entries.Empty();
+		Shard.InsertionOrder.Empty();
+		Shard.NextEviction = 0;
+	}
+}
+
+void FPicrossLineCache::ResetStats()
+{
+	Hits.Reset();
+	Misses.Reset();
+	Evictions.Reset();
+}
+
+FPicrossLineCacheStats FPicrossLineCache::GetStats() const
+{
+	FPicrossLineCacheStats Stats;
+	Stats.Hits = Hits.GetValue();
+	Stats.Misses = Misses.GetValue();
+	Stats.Evictions = Evictions.GetValue();
+	for (const FShard& Shard : Shards)
+	{
+		FRWScopeLock ReadLock(Shard.Lock, SLT_ReadOnly);
+		Stats.Entries += Shard.Entries.Num();
+		Stats.AllocatedBytes += Shard.Entries.GetAllocatedSize() + Shard.InsertionOrder.GetAllocatedSize();
+	}
+	return Stats;
+}
@@ -0,0 +1,81 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/ScopeRWLock.h"
+#include "PicrossLineSolver.h"
+
+/**
+ * A snapshot of the counters of a line cache.
+ */
+struct PICROSS_API FPicrossLineCacheStats
+{
+	int64 Hits = 0;
+	int64 Misses = 0;
+	int64 Evictions = 0;
+	int32 Entries = 0;
+	SIZE_T AllocatedBytes = 0;
+
+	double GetHitRate() const { return Hits + Misses > 0 ? double(Hits) / double(Hits + Misses) : 0.0; }
+	FString ToString() const;
+};
+
+/**
+ * Thread-safe cache of solved lines keyed by the clue, the length and the known cells of the line.
+ * The entries are spread over shards with their own read/write lock so parallel sweeps rarely wait on each other.
+ * Each shard holds at most its share of the memory cap and evicts its oldest entries first.
+ */
+class PICROSS_API FPicrossLineCache
+{
+public:
+	static constexpr int32 NumShards = 64;
+
+	/**
+	 * @param MaxBytes - Approximate upper bound of the memory used by the entries.
+	 */
+	explicit FPicrossLineCache(SIZE_T MaxBytes = 64 * 1024 * 1024);
+
+	/**
+	 * Same as FPicrossLineSolver::Solve but returns the cached solution when the line has been solved before.
+	 */
+	EPicrossLineResult Solve(TArrayView<const uint16> Clue, int32 Length, FPicrossLineState& InOutLine);
+
+	/**
+	 * Removes every entry, the counters are kept.
+	 */
+	void Empty();
+	void ResetStats();
+	FPicrossLineCacheStats GetStats() const;
+
+private:
+	struct FEntry
+	{
+		TArray<uint16, TInlineAllocator<16>> Clue;
+		int32 Length;
+		FPicrossLineState Line;
+		FPicrossLineState Solution;
+		EPicrossLineResult Result;
+
+		bool Matches(TArrayView<const uint16> InClue, int32 InLength, const FPicrossLineState& InLine) const;
+	};
+
+	struct FShard
+	{
+		mutable FRWLock Lock;
+		TMap<uint64, FEntry> Entries;
+		// Hashes in insertion order, NextEviction points at the oldest once the shard is full.
+		TArray<uint64> InsertionOrder;
+		int32 NextEviction = 0;
+	};
+
+	static uint64 HashLine(TArrayView<const uint16> Clue, int32 Length, const FPicrossLineState& Line);
+
+	FShard Shards[NumShards];
+	int32 MaxEntriesPerShard;
+
+	FThreadSafeCounter64 Hits;
+	FThreadSafeCounter64 Misses;
+	FThreadSafeCounter64 Evictions;
+};
@@ -0,0 +1,302 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossLineSolver.h"
+
+namespace
+{
+	uint64 ReverseBits(uint64 Bits)
+	{
+		Bits = ((Bits >> 1) & 0x5555555555555555ull) | ((Bits & 0x5555555555555555ull) << 1);
+		Bits = ((Bits >> 2) & 0x3333333333333333ull) | ((Bits & 0x3333333333333333ull) << 2);
+		Bits = ((Bits >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((Bits & 0x0F0F0F0F0F0F0F0Full) << 4);
+		Bits = ((Bits >> 8) & 0x00FF00FF00FF00FFull) | ((Bits & 0x00FF00FF00FF00FFull) << 8);
+		Bits = ((Bits >> 16) & 0x0000FFFF0000FFFFull) | ((Bits & 0x0000FFFF0000FFFFull) << 16);
+		return (Bits >> 32) | (Bits << 32);
+	}
+
+	// Marks every cell that starts a run of at least RunLength allowed cells, doubling the covered length each step.
+	FPicrossLineMask FindRunStarts(const FPicrossLineMask& Allowed, int32 RunLength)
+	{
+		FPicrossLineMask Runs = Allowed;
+		int32 Covered = 1;
+		while (Covered * 2 <= RunLength)
+		{
+			Runs &= Runs >> Covered;
+			Covered *= 2;
+		}
+		if (Covered < RunLength)
+		{
+			Runs &= Runs >> (RunLength - Covered);
+		}
+		return Runs;
+	}
+}
+
+bool FPicrossLineMask::IsEmpty() const
+{
+	uint64 Bits = 0;
+	for (int32 i = 0; i < NumWords; ++i)
+	{
+		Bits |= Words[i];
+	}
+	return Bits == 0;
+}
+
+int32 FPicrossLineMask::CountSetBits() const
+{
+	int32 Count = 0;
+	for (int32 i = 0; i < NumWords; ++i)
+	{
+		Count += static_cast<int32>(FPlatformMath::CountBits(Words[i]));
+	}
+	return Count;
+}
+
+int32 FPicrossLineMask::FindFirstSetBit(int32 From, int32 To) const
+{
+	if (From >= To) return INDEX_NONE;
+
+	int32 Word = From >> 6;
+	const int32 LastWord = (To - 1) >> 6;
+	uint64 Bits = Words[Word] & (~uint64(0) << (From & 63));
+	while (true)
+	{
+		if (Bits)
+		{
+			const int32 Index = (Word << 6) + static_cast<int32>(FPlatformMath::CountTrailingZeros64(Bits));
+			return Index < To ? Index : INDEX_NONE;
+		}
+		if (++Word > LastWord) return INDEX_NONE;
+		Bits = Words[Word];
+	}
+}
+
+int32 FPicrossLineMask::FindLastSetBit(int32 From, int32 To) const
+{
+	if (From >= To) return INDEX_NONE;
+
+	int32 Word = (To - 1) >> 6;
+	const int32 FirstWord = From >> 6;
+	uint64 Bits = Words[Word] & (~uint64(0) >> (63 - ((To - 1) & 63)));
+	while (true)
+	{
+		if (Bits)
+		{
+			const int32 Index = (Word << 6) + 63 - static_cast<int32>(FPlatformMath::CountLeadingZeros64(Bits));
+			return Index >= From ? Index : INDEX_NONE;
+		}
+		if (--Word < FirstWord) return INDEX_NONE;
+		Bits = Words[Word];
+	}
+}
+
+FPicrossLineMask FPicrossLineMask::Range(int32 From, int32 To)
+{
+	FPicrossLineMask Result;
+	From = FMath::Max(From, 0);
+	To = FMath::Min(To, MaxLength);
+	for (int32 i = 0; i < NumWords; ++i)
+	{
+		const int32 WordStart = FMath::Max(From, i * 64);
+		const int32 WordEnd = FMath::Min(To, (i + 1) * 64);
+		if (WordStart < WordEnd)
+		{
+			const int32 Count = WordEnd - WordStart;
+			const uint64 Bits = Count == 64 ? ~uint64(0) : ((uint64(1) << Count) - 1);
+			Result.Words[i] = Bits << (WordStart - i * 64);
+		}
+	}
+	return Result;
+}
+
+FPicrossLineMask FPicrossLineMask::Reverse(int32 Length) const
+{
+	FPicrossLineMask Result;
+	for (int32 i = 0; i < NumWords; ++i)
+	{
+		Result.Words[NumWords - 1 - i] = ReverseBits(Words[i]);
+	}
+	// The full reverse maps bit I to MaxLength - 1 - I, shift it down so it maps to Length - 1 - I instead.
+	return (Result >> (MaxLength - Length)) & Range(0, Length);
+}
+
+FPicrossLineMask FPicrossLineMask::operator<<(int32 Shift) const
+{
+	FPicrossLineMask Result;
+	const int32 WordShift = Shift >> 6;
+	const int32 BitShift = Shift & 63;
+	for (int32 i = NumWords - 1; i >= WordShift; --i)
+	{
+		Result.Words[i] = Words[i - WordShift] << BitShift;
+		if (BitShift && i - WordShift - 1 >= 0)
+		{
+			Result.Words[i] |= Words[i - WordShift - 1] >> (64 - BitShift);
+		}
+	}
+	return Result;
+}
+
+FPicrossLineMask FPicrossLineMask::operator>>(int32 Shift) const
+{
+	FPicrossLineMask Result;
+	const int32 WordShift = Shift >> 6;
+	const int32 BitShift = Shift & 63;
+	for (int32 i = 0; i + WordShift < NumWords; ++i)
+	{
+		Result.Words[i] = Words[i + WordShift] >> BitShift;
+		if (BitShift && i + WordShift + 1 < NumWords)
+		{
+			Result.Words[i] |= Words[i + WordShift + 1] << (64 - BitShift);
+		}
+	}
+	return Result;
+}
+
+FPicrossLineLayout::FPicrossLineLayout(FIntVector GridSize, EAxis::Type LineAxis)
+	: Axis(LineAxis)
+	// Axis1 is Y-axis if we're looking at the X-axis, otherwise it's the X-axis.
+	, Axis1Size(LineAxis == EAxis::X ? GridSize.Y : GridSize.X)
+	// Axis2 is Y-axis if we're looking at the Z-Axis, otherwise it's the Z-axis.
+	, Axis2Size(LineAxis == EAxis::Z ? GridSize.Y : GridSize.Z)
+	// Axis3 is the axis we're looking at.
+	, Length(LineAxis == EAxis::Z ? GridSize.Z : LineAxis == EAxis::X ? GridSize.X : GridSize.Y)
+{
+}
+
+FIntVector FPicrossLineLayout::ToXYZ(int32 Axis1, int32 Axis2, int32 Axis3) const
+{
+	return Axis == EAxis::X ? FIntVector(Axis3, Axis1, Axis2) : Axis == EAxis::Y ? FIntVector(Axis1, Axis3, Axis2) : FIntVector(Axis1, Axis2, Axis3);
+}
+
+void FPicrossLineLayout::FromXYZ(FIntVector XYZ, int32& OutLineIndex, int32& OutAxis3) const
+{
+	switch (Axis)
+	{
+		case EAxis::X:	OutLineIndex = GetLineIndex(XYZ.Y, XYZ.Z);	OutAxis3 = XYZ.X;	break;
+		case EAxis::Y:	OutLineIndex = GetLineIndex(XYZ.X, XYZ.Z);	OutAxis3 = XYZ.Y;	break;
+		default:		OutLineIndex = GetLineIndex(XYZ.X, XYZ.Y);	OutAxis3 = XYZ.Z;	break;
+	}
+}
+
+EPicrossLineResult FPicrossLineSolver::Solve(TArrayView<const uint16> Clue, int32 Length, FPicrossLineState& InOutLine)
+{
+	check(Length > 0 && Length <= FPicrossLineMask::MaxLength);
+
+	const int32 NumBlocks = Clue.Num();
+	FPicrossLineState Result = InOutLine;
+
+	if (NumBlocks == 0)
+	{
+		// A line without clues is empty.
+		if (!InOutLine.Filled.IsEmpty()) return EPicrossLineResult::Contradiction;
+		Result.Empty = FPicrossLineMask::Range(0, Length);
+	}
+	else
+	{
+		TArray<int32, TInlineAllocator<64>> LeftStarts;
+		TArray<int32, TInlineAllocator<64>> ReversedStarts;
+		TArray<uint16, TInlineAllocator<64>> ReversedClue;
+		LeftStarts.SetNumUninitialized(NumBlocks);
+		ReversedStarts.SetNumUninitialized(NumBlocks);
+		ReversedClue.SetNumUninitialized(NumBlocks);
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			ReversedClue[Block] = Clue[NumBlocks - 1 - Block];
+		}
+
+		// The rightmost placement is the leftmost placement of the mirrored line.
+		const FPicrossLineState ReversedLine{ InOutLine.Filled.Reverse(Length), InOutLine.Empty.Reverse(Length) };
+		if (!FindLeftmostPlacement(Clue, Length, InOutLine, LeftStarts.GetData())) return EPicrossLineResult::Contradiction;
+		if (!FindLeftmostPlacement(ReversedClue, Length, ReversedLine, ReversedStarts.GetData())) return EPicrossLineResult::Contradiction;
+
+		int32 PreviousRightEnd = 0;
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			const int32 LeftStart = LeftStarts[Block];
+			const int32 RightStart = Length - (ReversedStarts[NumBlocks - 1 - Block] + Clue[Block]);
+
+			// Cells covered by the block in both placements are filled in every placement.
+			Result.Filled |= FPicrossLineMask::Range(RightStart, LeftStart + Clue[Block]);
+			// Cells after the previous block in the rightmost placement and before this block in the leftmost placement can't be covered.
+			Result.Empty |= FPicrossLineMask::Range(PreviousRightEnd, LeftStart);
+			PreviousRightEnd = RightStart + Clue[Block];
+		}
+		Result.Empty |= FPicrossLineMask::Range(PreviousRightEnd, Length);
+	}
+
+	if (!(Result.Filled & Result.Empty).IsEmpty()) return EPicrossLineResult::Contradiction;
+	if (Result == InOutLine) return EPicrossLineResult::Unchanged;
+
+	InOutLine = Result;
+	return EPicrossLineResult::Changed;
+}
+
+bool FPicrossLineSolver::FindLeftmostPlacement(TArrayView<const uint16> Clue, int32 Length, const FPicrossLineState& Line, int32* OutStarts)
+{
+	const int32 NumBlocks = Clue.Num();
+	const FPicrossLineMask Allowed = ~Line.Empty & FPicrossLineMask::Range(0, Length);
+	const FPicrossLineMask NotAfterFilled = ~(Line.Filled << 1);
+
+	// A block can start at a cell if it fits within allowed cells and doesn't touch a filled cell on either side.
+	TArray<FPicrossLineMask, TInlineAllocator<16>> ValidStarts;
+	ValidStarts.SetNumUninitialized(NumBlocks);
+	for (int32 Block = 0; Block < NumBlocks; ++Block)
+	{
+		const int32 BlockLength = Clue[Block];
+		checkSlow(BlockLength > 0);
+		ValidStarts[Block] = (Block > 0 && Clue[Block - 1] == BlockLength) ? ValidStarts[Block - 1] : (FindRunStarts(Allowed, BlockLength) & NotAfterFilled & ~(Line.Filled >> BlockLength));
+	}
+
+	int32 Block = 0;
+	int32 SearchFrom = 0;
+	while (true)
+	{
+		if (Block == NumBlocks)
+		{
+			// Every filled cell after the last block has to be covered by moving the last block.
+			const int32 LastEnd = NumBlocks > 0 ? OutStarts[NumBlocks - 1] + Clue[NumBlocks - 1] : 0;
+			const int32 Uncovered = Line.Filled.FindLastSetBit(LastEnd, Length);
+			if (Uncovered == INDEX_NONE) return true;
+			if (NumBlocks == 0) return false;
+
+			Block = NumBlocks - 1;
+			SearchFrom = FMath::Max(OutStarts[Block] + 1, Uncovered - Clue[Block] + 1);
+			continue;
+		}
+
+		const int32 Gap = Block > 0 ? OutStarts[Block - 1] + Clue[Block - 1] + 1 : 0;
+		const int32 Start = ValidStarts[Block].FindFirstSetBit(FMath::Max(SearchFrom, Gap), Length);
+		if (Start == INDEX_NONE) return false;
+
+		// A filled cell skipped over can't be covered by this block, so the previous block has to move to cover it.
+		const int32 Skipped = Line.Filled.FindLastSetBit(Gap, Start);
+		if (Skipped != INDEX_NONE)
+		{
+			if (Block == 0) return false;
+
+			--Block;
+			SearchFrom = FMath::Max(OutStarts[Block] + 1, Skipped - Clue[Block] + 1);
+			continue;
+		}
+
+		OutStarts[Block++] = Start;
+		SearchFrom = 0;
+	}
+}
+
+void FPicrossLineSolver::GenerateClue(const FPicrossLineMask& Filled, int32 Length, TArray<uint16>& OutClue)
+{
+	OutClue.Reset();
+
+	const FPicrossLineMask Holes = ~Filled & FPicrossLineMask::Range(0, Length);
+	int32 Start = Filled.FindFirstSetBit(0, Length);
+	while (Start != INDEX_NONE)
+	{
+		int32 End = Holes.FindFirstSetBit(Start, Length);
+		if (End == INDEX_NONE) End = Length;
+
+		OutClue.Add(static_cast<uint16>(End - Start));
+		Start = Filled.FindFirstSetBit(End, Length);
+	}
+}
@@ -0,0 +1,138 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PicrossPuzzleClues.h"
+
+/**
+ * Fixed-capacity bitmask representing a single line of a puzzle, one bit per cell where bit 0 is the first cell along the axis.
+ * All operations work on whole 64-bit words so a line is handled 64 cells at a time.
+ */
+struct PICROSS_API FPicrossLineMask
+{
+	static constexpr int32 MaxLength = 256;
+	static constexpr int32 NumWords = MaxLength / 64;
+
+	uint64 Words[NumWords] = {};
+
+	FORCEINLINE bool Get(int32 Index) const { return (Words[Index >> 6] >> (Index & 63)) & 1; }
+	FORCEINLINE void Set(int32 Index) { Words[Index >> 6] |= uint64(1) << (Index & 63); }
+	FORCEINLINE void Clear(int32 Index) { Words[Index >> 6] &= ~(uint64(1) << (Index & 63)); }
+
+	bool IsEmpty() const;
+	int32 CountSetBits() const;
+
+	/**
+	 * Finds the first set bit within [From, To).
+	 * @returns the index of the bit or INDEX_NONE if there is none.
+	 */
+	int32 FindFirstSetBit(int32 From, int32 To) const;
+	/**
+	 * Finds the last set bit within [From, To).
+	 * @returns the index of the bit or INDEX_NONE if there is none.
+	 */
+	int32 FindLastSetBit(int32 From, int32 To) const;
+
+	/**
+	 * Creates a mask with the bits [From, To) set, an empty range gives an empty mask.
+	 */
+	static FPicrossLineMask Range(int32 From, int32 To);
+	/**
+	 * Mirrors the first Length bits so that bit I becomes bit Length - 1 - I.
+	 */
+	FPicrossLineMask Reverse(int32 Length) const;
+
+	// Shifts towards higher cell indices, bit I becomes bit I + Shift.
+	FPicrossLineMask operator<<(int32 Shift) const;
+	// Shifts towards lower cell indices, bit I becomes bit I - Shift.
+	FPicrossLineMask operator>>(int32 Shift) const;
+
+	FORCEINLINE FPicrossLineMask operator&(const FPicrossLineMask& Other) const { FPicrossLineMask Result; for (int32 i = 0; i < NumWords; ++i) Result.Words[i] = Words[i] & Other.Words[i]; return Result; }
+	FORCEINLINE FPicrossLineMask operator|(const FPicrossLineMask& Other) const { FPicrossLineMask Result; for (int32 i = 0; i < NumWords; ++i) Result.Words[i] = Words[i] | Other.Words[i]; return Result; }
+	FORCEINLINE FPicrossLineMask operator^(const FPicrossLineMask& Other) const { FPicrossLineMask Result; for (int32 i = 0; i < NumWords; ++i) Result.Words[i] = Words[i] ^ Other.Words[i]; return Result; }
+	FORCEINLINE FPicrossLineMask operator~() const { FPicrossLineMask Result; for (int32 i = 0; i < NumWords; ++i) Result.Words[i] = ~Words[i]; return Result; }
+	FORCEINLINE FPicrossLineMask& operator&=(const FPicrossLineMask& Other) { for (int32 i = 0; i < NumWords; ++i) Words[i] &= Other.Words[i]; return *this; }
+	FORCEINLINE FPicrossLineMask& operator|=(const FPicrossLineMask& Other) { for (int32 i = 0; i < NumWords; ++i) Words[i] |= Other.Words[i]; return *this; }
+	FORCEINLINE bool operator==(const FPicrossLineMask& Other) const { for (int32 i = 0; i < NumWords; ++i) if (Words[i] != Other.Words[i]) return false; return true; }
+	FORCEINLINE bool operator!=(const FPicrossLineMask& Other) const { return !(*this == Other); }
+};
+
+/**
+ * The known cells of a line, a cell is unknown when it's in neither mask.
+ */
+struct PICROSS_API FPicrossLineState
+{
+	FPicrossLineMask Filled;
+	FPicrossLineMask Empty;
+
+	bool IsSolved(int32 Length) const { return (Filled | Empty) == FPicrossLineMask::Range(0, Length); }
+	bool operator==(const FPicrossLineState& Other) const { return Filled == Other.Filled && Empty == Other.Empty; }
+	bool operator!=(const FPicrossLineState& Other) const { return !(*this == Other); }
+};
+
+/**
+ * Describes how the lines along an axis are laid out in the grid.
+ * Uses the same permutation as APicrossGrid::GenerateNumbersForAxis: Axis1 is Y for X-lines and X otherwise, Axis2 is Y for Z-lines and Z otherwise and Axis3 runs along the line.
+ */
+struct PICROSS_API FPicrossLineLayout
+{
+	FPicrossLineLayout() : Axis(EAxis::None), Axis1Size(0), Axis2Size(0), Length(0) {}
+	FPicrossLineLayout(FIntVector GridSize, EAxis::Type LineAxis);
+
+	int32 Num() const { return Axis1Size * Axis2Size; }
+	int32 GetLineIndex(int32 Axis1, int32 Axis2) const { return Axis2 * Axis1Size + Axis1; }
+
+	/**
+	 * De-anonymizes Axis1, Axis2 & Axis3 into their named version (X,Y,Z).
+	 */
+	FIntVector ToXYZ(int32 Axis1, int32 Axis2, int32 Axis3) const;
+	FIntVector ToXYZ(int32 LineIndex, int32 Axis3) const { return ToXYZ(LineIndex % Axis1Size, LineIndex / Axis1Size, Axis3); }
+	/**
+	 * Finds the line passing through XYZ along this axis and the position of XYZ on that line.
+	 */
+	void FromXYZ(FIntVector XYZ, int32& OutLineIndex, int32& OutAxis3) const;
+
+	EAxis::Type Axis;
+	int32 Axis1Size;
+	int32 Axis2Size;
+	int32 Length;
+};
+
+enum class EPicrossLineResult : uint8
+{
+	Unchanged,
+	Changed,
+	Contradiction
+};
+
+/**
+ * Bit-parallel line solver.
+ * Finds the leftmost and rightmost placement of the blocks with word-level operations and deduces the cells every placement agrees on.
+ */
+class PICROSS_API FPicrossLineSolver
+{
+public:
+	FPicrossLineSolver() = delete;
+
+	/**
+	 * Deduces as many cells as possible for a single line.
+	 * @param Clue - The run lengths of the line in order along the line.
+	 * @param Length - The number of cells in the line, at most FPicrossLineMask::MaxLength.
+	 * @param InOutLine - The known cells of the line, updated with the deduced cells.
+	 * @returns whether the line changed or Contradiction if no placement of the clue fits the known cells.
+	 */
+	static EPicrossLineResult Solve(TArrayView<const uint16> Clue, int32 Length, FPicrossLineState& InOutLine);
+
+	/**
+	 * Finds the leftmost valid start of every block.
+	 * @param OutStarts - Must have room for Clue.Num() elements.
+	 * @returns false if the blocks can't be placed.
+	 */
+	static bool FindLeftmostPlacement(TArrayView<const uint16> Clue, int32 Length, const FPicrossLineState& Line, int32* OutStarts);
+
+	/**
+	 * Finds the runs of set bits within the first Length bits of the line.
+	 */
+	static void GenerateClue(const FPicrossLineMask& Filled, int32 Length, TArray<uint16>& OutClue);
+};
@@ -0,0 +1,236 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossProber.h"
+#include "../PicrossBlock.h"
+#include "../PicrossPuzzleData.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+namespace
+{
+	struct FCellValue
+	{
+		FIntVector XYZ;
+		bool bFilled;
+	};
+
+	struct FProbeResult
+	{
+		bool bProbed = false;
+		// Both values of the cell contradict, the grid has no solution.
+		bool bContradiction = false;
+		// One value contradicted, so every cell is a consequence of the other value rather than an agreement.
+		bool bFromContradiction = false;
+		TArray<FCellValue> Cells;
+	};
+
+	bool IsCancelled(const FThreadSafeBool* CancelFlag, double Deadline)
+	{
+		return (CancelFlag && *CancelFlag) || (Deadline > 0.0 && FPlatformTime::Seconds() > Deadline);
+	}
+
+	/**
+	 * Collects the cells that aren't known in the base grid but are known with the same value in the other grids.
+	 * @param Other - Optional second grid that also has to agree.
+	 */
+	void CollectNewCells(const FPicrossSolverGrid& Base, const FPicrossSolverGrid& Branch, const FPicrossSolverGrid* Other, TArray<FCellValue>& OutCells)
+	{
+		const FPicrossLineLayout& Layout = Base.GetLayout(EAxis::X);
+		for (int32 LineIndex = 0; LineIndex < Layout.Num(); ++LineIndex)
+		{
+			const FPicrossLineState& BaseLine = Base.GetLine(EAxis::X, LineIndex);
+			FPicrossLineState Known = Branch.GetLine(EAxis::X, LineIndex);
+			if (Other)
+			{
+				Known.Filled &= Other->GetLine(EAxis::X, LineIndex).Filled;
+				Known.Empty &= Other->GetLine(EAxis::X, LineIndex).Empty;
+			}
+
+			for (const bool bFilled : { true, false })
+			{
+				const FPicrossLineMask NewCells = bFilled ? Known.Filled & ~BaseLine.Filled : Known.Empty & ~BaseLine.Empty;
+				for (int32 Axis3 = NewCells.FindFirstSetBit(0, Layout.Length); Axis3 != INDEX_NONE; Axis3 = NewCells.FindFirstSetBit(Axis3 + 1, Layout.Length))
+				{
+					OutCells.Add(FCellValue{ Layout.ToXYZ(LineIndex, Axis3), bFilled });
+				}
+			}
+		}
+	}
+
+	void ProbeCell(const FPicrossGridSolver& Solver, const FPicrossSolverGrid& Grid, FIntVector Cell, FProbeResult& OutResult)
+	{
+		FPicrossLineWorklist Worklist;
+		Worklist.Init(Grid.GetGridSize());
+
+		FPicrossSolverGrid Branches[2] = { Grid, Grid };
+		bool bContradicts[2];
+		for (int32 BranchIndex = 0; BranchIndex < 2; ++BranchIndex)
+		{
+			Branches[BranchIndex].SetCell(Cell, BranchIndex == 0, &Worklist);
+			bContradicts[BranchIndex] = Solver.Propagate(Branches[BranchIndex], Worklist) == EPicrossSolveResult::Contradiction;
+		}
+
+		OutResult.bProbed = true;
+		if (bContradicts[0] && bContradicts[1])
+		{
+			OutResult.bContradiction = true;
+		}
+		else if (bContradicts[0] || bContradicts[1])
+		{
+			OutResult.bFromContradiction = true;
+			CollectNewCells(Grid, Branches[bContradicts[0] ? 1 : 0], nullptr, OutResult.Cells);
+		}
+		else
+		{
+			CollectNewCells(Grid, Branches[0], &Branches[1], OutResult.Cells);
+		}
+	}
+}
+
+FPicrossProbeStats& FPicrossProbeStats::operator+=(const FPicrossProbeStats& Other)
+{
+	Rounds += Other.Rounds;
+	Batches += Other.Batches;
+	Probes += Other.Probes;
+	CellsFromContradictions += Other.CellsFromContradictions;
+	CellsFromAgreement += Other.CellsFromAgreement;
+	TotalSeconds += Other.TotalSeconds;
+	return *this;
+}
+
+FString FPicrossProbeStats::ToString() const
+{
+	return FString::Printf(TEXT("Rounds: %d, Batches: %d, Probes: %lld, Cells from contradictions: %lld, from agreement: %lld, Total: %.3fms"),
+		Rounds, Batches, Probes, CellsFromContradictions, CellsFromAgreement, TotalSeconds * 1000.0);
+}
+
+FPicrossProber::FPicrossProber(const FPicrossGridSolver& InSolver)
+	: Solver(InSolver)
+{
+}
+
+EPicrossSolveResult FPicrossProber::Solve(FPicrossSolverGrid& Grid, FPicrossProbeStats* Stats, const FThreadSafeBool* CancelFlag) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FPicrossProbeStats LocalStats;
+
+	// Each probe only propagates from a single cell so going wide inside a probe costs more than it gains.
+	FPicrossGridSolver ProbeSolver(Solver.GetClues());
+	ProbeSolver.SetParallel(false);
+	ProbeSolver.SetCache(Solver.GetCache());
+
+	FPicrossLineWorklist Worklist;
+	Worklist.Init(Grid.GetGridSize());
+	Worklist.AddAll();
+	EPicrossSolveResult Result = Solver.Propagate(Grid, Worklist);
+
+	TArray<FIntVector> Candidates;
+	TArray<FProbeResult> Results;
+	bool bChanged = true;
+	while (Result == EPicrossSolveResult::Stalled && bChanged && !IsCancelled(CancelFlag, Deadline))
+	{
+		++LocalStats.Rounds;
+		bChanged = false;
+
+		Candidates.Reset();
+		const FIntVector GridSize = Grid.GetGridSize();
+		for (int32 Z = 0; Z < GridSize.Z; ++Z)
+		{
+			for (int32 Y = 0; Y < GridSize.Y; ++Y)
+			{
+				for (int32 X = 0; X < GridSize.X; ++X)
+				{
+					if (Grid.GetCell(FIntVector(X, Y, Z)) == EBlockState::Clear)
+					{
+						Candidates.Add(FIntVector(X, Y, Z));
+					}
+				}
+			}
+		}
+
+		for (int32 BatchStart = 0; BatchStart < Candidates.Num() && Result == EPicrossSolveResult::Stalled; BatchStart += BatchSize)
+		{
+			if (IsCancelled(CancelFlag, Deadline)) break;
+			++LocalStats.Batches;
+
+			const int32 NumProbes = FMath::Min(BatchSize, Candidates.Num() - BatchStart);
+			Results.Reset();
+			Results.SetNum(NumProbes);
+			FThreadSafeBool bContradiction;
+			ParallelFor(NumProbes, [&](int32 Index)
+			{
+				// A single contradiction settles the whole grid, the rest of the batch is pointless.
+				if (bContradiction || IsCancelled(CancelFlag, Deadline)) return;
+
+				const FIntVector Cell = Candidates[BatchStart + Index];
+				if (Grid.GetCell(Cell) != EBlockState::Clear) return;
+
+				ProbeCell(ProbeSolver, Grid, Cell, Results[Index]);
+				if (Results[Index].bContradiction)
+				{
+					bContradiction = true;
+				}
+			}, !bParallel);
+
+			if (bContradiction)
+			{
+				Result = EPicrossSolveResult::Contradiction;
+				break;
+			}
+
+			// Every deduction holds for the grid the batch started from, so they are all still valid after the ones before them are applied.
+			for (const FProbeResult& ProbeResult : Results)
+			{
+				LocalStats.Probes += ProbeResult.bProbed ? 1 : 0;
+				for (const FCellValue& CellValue : ProbeResult.Cells)
+				{
+					if (Grid.GetCell(CellValue.XYZ) != EBlockState::Clear)
+					{
+						if (!Grid.SetCell(CellValue.XYZ, CellValue.bFilled))
+						{
+							Result = EPicrossSolveResult::Contradiction;
+						}
+						continue;
+					}
+
+					Grid.SetCell(CellValue.XYZ, CellValue.bFilled, &Worklist);
+					++(ProbeResult.bFromContradiction ? LocalStats.CellsFromContradictions : LocalStats.CellsFromAgreement);
+					bChanged = true;
+				}
+			}
+
+			if (Result == EPicrossSolveResult::Contradiction)
+			{
+				Worklist.Reset();
+				break;
+			}
+			if (!Worklist.IsEmpty())
+			{
+				Result = Solver.Propagate(Grid, Worklist);
+			}
+		}
+	}
+
+	LocalStats.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	if (Stats)
+	{
+		*Stats += LocalStats;
+	}
+	return Result;
+}
+
+bool FPicrossProber::Solve(const UPicrossPuzzleData& PuzzleData, FPicrossSolverOutput& OutOutput, FPicrossProbeStats* Stats)
+{
+	FPicrossPuzzleClues PuzzleClues;
+	if (!PuzzleClues.Generate(PuzzleData)) return false;
+
+	const FPicrossGridSolver Solver(PuzzleClues);
+	FPicrossSolverGrid Grid;
+	Solver.InitGrid(Grid);
+
+	OutOutput.Stats = FPicrossSolverStats();
+	OutOutput.Result = FPicrossProber(Solver).Solve(Grid, Stats);
+	Grid.ToBlockStates(OutOutput.Grid);
+	return true;
+}
@@ -0,0 +1,65 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "PicrossGridSolver.h"
+
+/**
+ * Statistics gathered while probing.
+ */
+struct PICROSS_API FPicrossProbeStats
+{
+	int32 Rounds = 0;
+	int32 Batches = 0;
+	int64 Probes = 0;
+	// Cells deduced because one of their values led to a contradiction.
+	int64 CellsFromContradictions = 0;
+	// Cells deduced because both values of a probed cell agreed on them.
+	int64 CellsFromAgreement = 0;
+	double TotalSeconds = 0.0;
+
+	FPicrossProbeStats& operator+=(const FPicrossProbeStats& Other);
+	FString ToString() const;
+};
+
+/**
+ * Contradiction lookahead for grids where propagation stalls.
+ * Tentatively sets an undecided cell to filled and to empty, propagates both and keeps what they agree on, or the other value if one of them contradicts.
+ * Probes only read the grid so a batch of them is evaluated in parallel on copies before the deductions are applied and propagated.
+ */
+class PICROSS_API FPicrossProber
+{
+public:
+	explicit FPicrossProber(const FPicrossGridSolver& InSolver);
+
+	void SetParallel(bool bInParallel) { bParallel = bInParallel; }
+	/**
+	 * @param InBatchSize - Number of cells probed against the same grid before their deductions are applied.
+	 */
+	void SetBatchSize(int32 InBatchSize) { BatchSize = FMath::Max(InBatchSize, 1); }
+	/**
+	 * @param InDeadline - FPlatformTime::Seconds() after which probing stops as if cancelled, 0 means no deadline.
+	 */
+	void SetDeadline(double InDeadline) { Deadline = InDeadline; }
+
+	/**
+	 * Alternates propagation and probing until neither deduces anything more.
+	 * @param CancelFlag - Optional flag another thread can raise to stop probing, the grid is left with whatever was deduced so far.
+	 * @returns Stalled if cancelled before the grid was solved.
+	 */
+	EPicrossSolveResult Solve(FPicrossSolverGrid& Grid, FPicrossProbeStats* Stats = nullptr, const FThreadSafeBool* CancelFlag = nullptr) const;
+
+	/**
+	 * Solves a puzzle from its clues alone by propagation and probing.
+	 * @returns false if the puzzle isn't valid.
+	 */
+	static bool Solve(const UPicrossPuzzleData& PuzzleData, FPicrossSolverOutput& OutOutput, FPicrossProbeStats* Stats = nullptr);
+
+private:
+	const FPicrossGridSolver& Solver;
+	int32 BatchSize = 256;
+	double Deadline = 0.0;
+	bool bParallel = true;
+};
@@ -0,0 +1,286 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossPuzzleClues.h"
+#include "PicrossGridDispatch.h"
+#include "PicrossLineSolver.h"
+#include "../PicrossPuzzleData.h"
+#include "../PicrossSolution.h"
+#include "FArray3D.h"
+
+namespace
+{
+	// The clues are generated from unpacked solutions as well as packed ones, the index is always within the solution.
+	FORCEINLINE bool IsCellFilled(const TArray<bool>& Solution, int32 MasterIndex) { return Solution.GetData()[MasterIndex]; }
+	FORCEINLINE bool IsCellFilled(const FPicrossSolution& Solution, int32 MasterIndex) { return Solution.Get(MasterIndex); }
+
+	template<typename DimensionsType, int32 AxisIndex, typename SolutionType>
+	void GenerateLineClue(const TPicrossLineLayout<DimensionsType, AxisIndex>& Layout, int32 LineIndex, const SolutionType& Solution, TArray<uint16>& OutClue)
+	{
+		FPicrossLineMask Filled;
+		int32 MasterIndex = Layout.GetLineStart(LineIndex);
+		for (int32 Axis3 = 0; Axis3 < Layout.Length(); ++Axis3, MasterIndex += Layout.GetStride())
+		{
+			if (IsCellFilled(Solution, MasterIndex))
+			{
+				Filled.Set(Axis3);
+			}
+		}
+		FPicrossLineSolver::GenerateClue(Filled, Layout.Length(), OutClue);
+	}
+
+	template<int32 AxisIndex, typename DimensionsType, typename SolutionType>
+	void GenerateAxisClues(const DimensionsType& Dimensions, const SolutionType& Solution, TArray<uint16>& OutRuns, TArray<int32>& OutRunOffsets)
+	{
+		const TPicrossLineLayout<DimensionsType, AxisIndex> Layout(Dimensions);
+		TArray<uint16> Clue;
+		for (int32 LineIndex = 0; LineIndex < Layout.Num(); ++LineIndex)
+		{
+			GenerateLineClue(Layout, LineIndex, Solution, Clue);
+			OutRuns.Append(Clue);
+			OutRunOffsets.Add(OutRuns.Num());
+		}
+	}
+
+	bool ClueEquals(TArrayView<const uint16> A, TArrayView<const uint16> B)
+	{
+		return A.Num() == B.Num() && (A.Num() == 0 || FMemory::Memcmp(A.GetData(), B.GetData(), A.Num() * sizeof(uint16)) == 0);
+	}
+
+	template<int32 AxisIndex, typename DimensionsType>
+	void UpdateAxisClues(const DimensionsType& Dimensions, const TArray<bool>& Solution, TArrayView<const int32> ChangedCells, const FPicrossPuzzleClues& Clues, TArray<TPair<int32, TArray<uint16>>>& OutNewClues)
+	{
+		const TPicrossLineLayout<DimensionsType, AxisIndex> Layout(Dimensions);
+
+		// A box edit changes many cells on the same lines, each line only needs to be regenerated once.
+		TSet<int32> DirtyLines;
+		for (const int32 MasterIndex : ChangedCells)
+		{
+			int32 LineIndex, Axis3;
+			Layout.FromXYZ(Dimensions.TranslateTo3D(MasterIndex), LineIndex, Axis3);
+			DirtyLines.Add(LineIndex);
+		}
+
+		TArray<uint16> NewClue;
+		for (const int32 LineIndex : DirtyLines)
+		{
+			GenerateLineClue(Layout, LineIndex, Solution, NewClue);
+			if (!ClueEquals(NewClue, Clues.GetClue(Layout.GetAxis(), LineIndex)))
+			{
+				OutNewClues.Emplace(LineIndex, NewClue);
+			}
+		}
+	}
+}
+
+bool FPicrossPuzzleClues::Generate(const UPicrossPuzzleData& PuzzleData)
+{
+	if (!PuzzleData.ValidatePuzzle()) return false;
+
+	// The asset generated the table when its solution was set or loaded, or loaded it along with the solution.
+	const FPicrossPuzzleClues& PuzzleClues = PuzzleData.GetClues();
+	if (PuzzleClues.GridSize != PuzzleData.GetGridSize()) return false;
+
+	*this = PuzzleClues;
+	return true;
+}
+
+bool FPicrossPuzzleClues::Generate(FIntVector InGridSize, const TArray<bool>& Solution)
+{
+	return GenerateFrom(InGridSize, Solution);
+}
+
+bool FPicrossPuzzleClues::Generate(FIntVector InGridSize, const FPicrossSolution& Solution)
+{
+	return GenerateFrom(InGridSize, Solution);
+}
+
+template<typename SolutionType>
+bool FPicrossPuzzleClues::GenerateFrom(FIntVector InGridSize, const SolutionType& Solution)
+{
+	if (!FArray3D::ValidateDimensions(InGridSize) || Solution.Num() != FArray3D::Size(InGridSize)) return false;
+
+	GridSize = InGridSize;
+	if (GridSize.GetMax() > FPicrossLineMask::MaxLength) return false;
+
+	InitLines();
+	Runs.Reset();
+	RunOffsets.Reset(FirstLines[3] + 1);
+	RunOffsets.Add(0);
+
+	// The index math is picked once for the whole puzzle instead of per cell.
+	FPicrossGridDispatch::Dispatch(GridSize, [this, &Solution](auto Dimensions)
+	{
+		GenerateAxisClues<0>(Dimensions, Solution, Runs, RunOffsets);
+		GenerateAxisClues<1>(Dimensions, Solution, Runs, RunOffsets);
+		GenerateAxisClues<2>(Dimensions, Solution, Runs, RunOffsets);
+	});
+	InitRunCounts();
+
+	return true;
+}
+
+void FPicrossPuzzleClues::Update(const TArray<bool>& Solution, TArrayView<const int32> ChangedCells, TArray<TPair<EAxis::Type, int32>>* OutChangedLines)
+{
+	check(Solution.Num() == FArray3D::Size(GridSize));
+
+	TArray<TPair<int32, TArray<uint16>>> AxisNewClues[3];
+	FPicrossGridDispatch::Dispatch(GridSize, [this, &Solution, ChangedCells, &AxisNewClues](auto Dimensions)
+	{
+		UpdateAxisClues<0>(Dimensions, Solution, ChangedCells, *this, AxisNewClues[0]);
+		UpdateAxisClues<1>(Dimensions, Solution, ChangedCells, *this, AxisNewClues[1]);
+		UpdateAxisClues<2>(Dimensions, Solution, ChangedCells, *this, AxisNewClues[2]);
+	});
+
+	TArray<TPair<int32, TArray<uint16>>> NewClues;
+	for (int32 AxisIndex = 0; AxisIndex < 3; ++AxisIndex)
+	{
+		for (TPair<int32, TArray<uint16>>& NewClue : AxisNewClues[AxisIndex])
+		{
+			if (OutChangedLines)
+			{
+				OutChangedLines->Emplace(static_cast<EAxis::Type>(EAxis::X + AxisIndex), NewClue.Key);
+			}
+			NewClues.Emplace(FirstLines[AxisIndex] + NewClue.Key, MoveTemp(NewClue.Value));
+		}
+	}
+	SetClues(NewClues);
+}
+
+void FPicrossPuzzleClues::ReserveLineSlack()
+{
+	if (!IsValid()) return;
+
+	int32 NumSlackRuns = 0;
+	for (int32 Line = 0; Line < FirstLines[3]; ++Line)
+	{
+		NumSlackRuns += (GetLineLength(Line) + 1) / 2;
+	}
+	if (NumSlackRuns == Runs.Num()) return;
+
+	TArray<uint16> NewRuns;
+	NewRuns.SetNumZeroed(NumSlackRuns);
+	int32 Start = 0;
+	for (int32 Line = 0; Line < FirstLines[3]; ++Line)
+	{
+		for (int32 Run = 0; Run < RunCounts[Line]; ++Run)
+		{
+			NewRuns[Start + Run] = Runs[RunOffsets[Line] + Run];
+		}
+		RunOffsets[Line] = Start;
+		Start += (GetLineLength(Line) + 1) / 2;
+	}
+	RunOffsets[FirstLines[3]] = Start;
+	Runs = MoveTemp(NewRuns);
+}
+
+bool FPicrossPuzzleClues::IsValid() const
+{
+	if (GridSize.GetMin() <= 0 || GridSize.GetMax() > FPicrossLineMask::MaxLength) return false;
+	if (FirstLines[3] != GridSize.Y * GridSize.Z + GridSize.X * GridSize.Z + GridSize.X * GridSize.Y) return false;
+	if (RunOffsets.Num() != FirstLines[3] + 1 || RunCounts.Num() != FirstLines[3] || RunOffsets[0] != 0 || RunOffsets.Last() != Runs.Num()) return false;
+
+	for (int32 Line = 0; Line < FirstLines[3]; ++Line)
+	{
+		if (RunOffsets[Line + 1] - RunOffsets[Line] < RunCounts[Line]) return false;
+	}
+	return true;
+}
+
+bool FPicrossPuzzleClues::operator==(const FPicrossPuzzleClues& Other) const
+{
+	if (GridSize != Other.GridSize || RunCounts != Other.RunCounts) return false;
+
+	for (int32 Line = 0; Line < RunCounts.Num(); ++Line)
+	{
+		if (RunCounts[Line] > 0 && FMemory::Memcmp(Runs.GetData() + RunOffsets[Line], Other.Runs.GetData() + Other.RunOffsets[Line], RunCounts[Line] * sizeof(uint16)) != 0) return false;
+	}
+	return true;
+}
+
+FArchive& operator<<(FArchive& Ar, FPicrossPuzzleClues& Clues)
+{
+	Ar << Clues.GridSize;
+
+	if (Ar.IsLoading())
+	{
+		Ar << Clues.Runs;
+		Ar << Clues.RunOffsets;
+		Clues.InitLines();
+		Clues.InitRunCounts();
+	}
+	else
+	{
+		// Always written packed, the slack only matters while the table is being edited.
+		TArray<uint16> PackedRuns;
+		TArray<int32> PackedRunOffsets;
+		Clues.GetPackedRuns(PackedRuns, PackedRunOffsets);
+		Ar << PackedRuns;
+		Ar << PackedRunOffsets;
+	}
+	return Ar;
+}
+
+void FPicrossPuzzleClues::InitLines()
+{
+	// A loaded size isn't trusted until IsValid, the products can't overflow once every axis is within MaxLength.
+	const bool bValidSize = GridSize.GetMin() > 0 && GridSize.GetMax() <= FPicrossLineMask::MaxLength;
+	const FIntVector Size = bValidSize ? GridSize : FIntVector::ZeroValue;
+
+	FirstLines[0] = 0;
+	FirstLines[1] = FirstLines[0] + Size.Y * Size.Z;
+	FirstLines[2] = FirstLines[1] + Size.X * Size.Z;
+	FirstLines[3] = FirstLines[2] + Size.X * Size.Y;
+}
+
+void FPicrossPuzzleClues::InitRunCounts()
+{
+	RunCounts.Reset();
+	if (RunOffsets.Num() != FirstLines[3] + 1 || RunOffsets[0] != 0 || RunOffsets.Last() != Runs.Num()) return;
+
+	for (int32 Line = 0; Line < FirstLines[3]; ++Line)
+	{
+		const int32 NumRuns = RunOffsets[Line + 1] - RunOffsets[Line];
+		if (NumRuns < 0 || NumRuns > MAX_uint16)
+		{
+			RunCounts.Reset();
+			return;
+		}
+		RunCounts.Add(static_cast<uint16>(NumRuns));
+	}
+}
+
+void FPicrossPuzzleClues::GetPackedRuns(TArray<uint16>& OutRuns, TArray<int32>& OutRunOffsets) const
+{
+	OutRuns.Reset();
+	OutRunOffsets.Reset(RunCounts.Num() + 1);
+	OutRunOffsets.Add(0);
+	for (int32 Line = 0; Line < RunCounts.Num(); ++Line)
+	{
+		OutRuns.Append(Runs.GetData() + RunOffsets[Line], RunCounts[Line]);
+		OutRunOffsets.Add(OutRuns.Num());
+	}
+}
+
+void FPicrossPuzzleClues::SetClues(TArrayView<const TPair<int32, TArray<uint16>>> NewClues)
+{
+	for (const TPair<int32, TArray<uint16>>& NewClue : NewClues)
+	{
+		if (NewClue.Value.Num() > RunOffsets[NewClue.Key + 1] - RunOffsets[NewClue.Key])
+		{
+			// Only moves the runs once, afterwards every line has room for all the runs it can have.
+			ReserveLineSlack();
+			break;
+		}
+	}
+
+	for (const TPair<int32, TArray<uint16>>& NewClue : NewClues)
+	{
+		check(NewClue.Value.Num() <= RunOffsets[NewClue.Key + 1] - RunOffsets[NewClue.Key]);
+		for (int32 Run = 0; Run < NewClue.Value.Num(); ++Run)
+		{
+			Runs[RunOffsets[NewClue.Key] + Run] = NewClue.Value[Run];
+		}
+		RunCounts[NewClue.Key] = static_cast<uint16>(NewClue.Value.Num());
+	}
+}
@@ -0,0 +1,91 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Forward declarations
+class UPicrossPuzzleData;
+struct FPicrossSolution;
+
+/**
+ * The clues for every line of a puzzle as one flat table, the run lengths of all lines back to back with the offset and number of runs of every line.
+ * The X-lines come first, then the Y and Z-lines, each axis in LineIndex order with the runs of a line ordered along increasing Axis3.
+ * Generated and loaded tables are packed, ReserveLineSlack gives every line room for as many runs as it can have so edited tables update in place.
+ * Note that the Z-axis numbers are displayed reversed, the clues here are not.
+ */
+struct PICROSS_API FPicrossPuzzleClues
+{
+	/**
+	 * Copies the clue table the puzzle asset keeps for its solution, see UPicrossPuzzleData::GetClues.
+	 * @returns false if the puzzle isn't valid or has lines longer than FPicrossLineMask::MaxLength.
+	 */
+	bool Generate(const UPicrossPuzzleData& PuzzleData);
+	/**
+	 * Generates the clues from a solution in MasterIndex order, for solutions that don't live in a puzzle asset.
+	 * @returns false if the size and the solution don't match or the size has lines longer than FPicrossLineMask::MaxLength.
+	 */
+	bool Generate(FIntVector InGridSize, const TArray<bool>& Solution);
+	/**
+	 * Same as above but reads the packed solution directly, see UPicrossPuzzleData::GetSolution.
+	 */
+	bool Generate(FIntVector InGridSize, const FPicrossSolution& Solution);
+	/**
+	 * Regenerates only the clues of the X, Y & Z lines passing through the changed cells, so an edit costs the lines it touches rather than the whole grid.
+	 * The new runs are written in place, a packed table gets its line slack reserved the first time a line outgrows its runs.
+	 * @param Solution - The whole solution after the edit in MasterIndex order, with the size the clues were generated for.
+	 * @param OutChangedLines - Optional, receives the axis and line index of every line whose clue changed.
+	 */
+	void Update(const TArray<bool>& Solution, TArrayView<const int32> ChangedCells, TArray<TPair<EAxis::Type, int32>>* OutChangedLines = nullptr);
+	/**
+	 * Gives every line room for ceil(Length / 2) runs, the most a line of its length can have, so Update never has to move the other lines.
+	 */
+	void ReserveLineSlack();
+
+	TArrayView<const uint16> GetClue(EAxis::Type Axis, int32 LineIndex) const
+	{
+		const int32 Line = FirstLines[Axis - EAxis::X] + LineIndex;
+		return TArrayView<const uint16>(Runs.GetData() + RunOffsets[Line], RunCounts[Line]);
+	}
+	int32 NumLines(EAxis::Type Axis) const { return FirstLines[Axis - EAxis::X + 1] - FirstLines[Axis - EAxis::X]; }
+	/**
+	 * Checks that the offsets describe a table for GridSize, for tables that were loaded rather than generated.
+	 */
+	bool IsValid() const;
+
+	/**
+	 * Compares the clues of every line, regardless of how much slack either table has.
+	 */
+	bool operator==(const FPicrossPuzzleClues& Other) const;
+	bool operator!=(const FPicrossPuzzleClues& Other) const { return !(*this == Other); }
+	friend PICROSS_API FArchive& operator<<(FArchive& Ar, FPicrossPuzzleClues& Clues);
+
+	FIntVector GridSize = FIntVector::ZeroValue;
+
+private:
+	template<typename SolutionType>
+	bool GenerateFrom(FIntVector InGridSize, const SolutionType& Solution);
+	void InitLines();
+	/**
+	 * Counts the runs of every line from the offsets of a packed table, leaves the counts empty if the offsets don't describe a table.
+	 */
+	void InitRunCounts();
+	int32 GetLineLength(int32 Line) const { return Line < FirstLines[1] ? GridSize.X : Line < FirstLines[2] ? GridSize.Y : GridSize.Z; }
+	/**
+	 * Copies the runs without slack, the way the table is serialized.
+	 */
+	void GetPackedRuns(TArray<uint16>& OutRuns, TArray<int32>& OutRunOffsets) const;
+	/**
+	 * Replaces the runs of the given lines in place, Key is the line within the whole table.
+	 */
+	void SetClues(TArrayView<const TPair<int32, TArray<uint16>>> NewClues);
+
+	// The run lengths of every line, followed by the unused slack of the line.
+	TArray<uint16> Runs;
+	// Where the runs of every line start in Runs, with one extra offset at the end so line I has room for RunOffsets[I + 1] - RunOffsets[I] runs.
+	TArray<int32> RunOffsets;
+	// How many runs every line has.
+	TArray<uint16> RunCounts;
+	// The first line of every axis in RunOffsets, the last element is the number of lines.
+	int32 FirstLines[4] = { 0, 0, 0, 0 };
+};
@@ -0,0 +1,160 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossPuzzleGenerator.h"
+#include "Async/ParallelFor.h"
+#include "FArray3D.h"
+#include "TArray3D.h"
+#include "Math/RandomStream.h"
+
+namespace
+{
+	// Every candidate runs its own single-threaded verifier, so the caches are kept small to bound the memory of a wide run.
+	constexpr SIZE_T CandidateCacheBytes = 8 * 1024 * 1024;
+
+	void GenerateNoise(float NoiseScale, FRandomStream& Stream, TArray3D<float>& OutValues)
+	{
+		const FIntVector GridSize = OutValues.GetDimensions();
+		const float Scale = FMath::Max(NoiseScale, 1.f);
+		TArray3D<float> Lattice(FIntVector(FMath::CeilToInt(GridSize.X / Scale) + 2, FMath::CeilToInt(GridSize.Y / Scale) + 2, FMath::CeilToInt(GridSize.Z / Scale) + 2));
+		for (float& Value : Lattice)
+		{
+			Value = Stream.FRand();
+		}
+
+		const TArray3D<float>::BoxType Cells = OutValues.GetBox();
+		for (auto It = Cells.begin(); It != Cells.end(); ++It)
+		{
+			const FIntVector XYZ = It.GetPosition();
+			const float Position[3] = { XYZ.X / Scale, XYZ.Y / Scale, XYZ.Z / Scale };
+			int32 Corner[3];
+			float Alpha[3];
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				Corner[Axis] = FMath::FloorToInt(Position[Axis]);
+				const float Fraction = Position[Axis] - Corner[Axis];
+				Alpha[Axis] = Fraction * Fraction * (3.f - 2.f * Fraction);
+			}
+
+			float Value = 0.f;
+			for (int32 CornerIndex = 0; CornerIndex < 8; ++CornerIndex)
+			{
+				const int32 DX = CornerIndex & 1, DY = (CornerIndex >> 1) & 1, DZ = (CornerIndex >> 2) & 1;
+				const float Weight = (DX ? Alpha[0] : 1.f - Alpha[0]) * (DY ? Alpha[1] : 1.f - Alpha[1]) * (DZ ? Alpha[2] : 1.f - Alpha[2]);
+				Value += Weight * Lattice(Corner[0] + DX, Corner[1] + DY, Corner[2] + DZ);
+			}
+			*It = Value;
+		}
+	}
+
+	/**
+	 * Fills the cells with the highest values, thresholding at the right rank gives exactly the requested density for any distribution.
+	 */
+	void GenerateSolution(const FPicrossGeneratorSettings& Settings, FRandomStream& Stream, TArray<bool>& OutSolution)
+	{
+		const int32 NumCells = FArray3D::Size(Settings.GridSize);
+		TArray3D<float> Values(Settings.GridSize);
+		if (Settings.Shape == EPicrossGeneratorShape::Noise)
+		{
+			GenerateNoise(Settings.NoiseScale, Stream, Values);
+		}
+		else
+		{
+			for (float& Value : Values)
+			{
+				Value = Stream.FRand();
+			}
+		}
+
+		TArray<float> SortedValues = Values.GetArray();
+		SortedValues.Sort();
+		const int32 FilledCells = FMath::Clamp(FMath::RoundToInt(Settings.Density * NumCells), 1, NumCells);
+		const float Threshold = SortedValues[NumCells - FilledCells];
+
+		// Row-major storage is in MasterIndex order.
+		OutSolution.SetNumUninitialized(NumCells);
+		for (int32 Index = 0; Index < NumCells; ++Index)
+		{
+			OutSolution[Index] = Values.GetArray()[Index] >= Threshold;
+		}
+	}
+
+	/**
+	 * Picks a random cell with the given state.
+	 * @returns INDEX_NONE if there is no such cell.
+	 */
+	int32 PickCell(const TArray<bool>& Solution, bool bFilled, FRandomStream& Stream)
+	{
+		const int32 Start = Stream.RandHelper(Solution.Num());
+		for (int32 Offset = 0; Offset < Solution.Num(); ++Offset)
+		{
+			const int32 Index = (Start + Offset) % Solution.Num();
+			if (Solution[Index] == bFilled) return Index;
+		}
+		return INDEX_NONE;
+	}
+}
+
+bool FPicrossPuzzleGenerator::Generate(const FPicrossGeneratorSettings& Settings, int32 Seed, FPicrossGeneratedPuzzle& OutPuzzle)
+{
+	if (!FArray3D::ValidateDimensions(Settings.GridSize) || Settings.GridSize.GetMax() > FPicrossLineMask::MaxLength) return false;
+
+	FRandomStream Stream(Seed);
+	OutPuzzle = FPicrossGeneratedPuzzle();
+	OutPuzzle.GridSize = Settings.GridSize;
+	OutPuzzle.Seed = Seed;
+	GenerateSolution(Settings, Stream, OutPuzzle.Solution);
+
+	// The check runs the way the rater would, so a unique candidate is rated from it without being solved again.
+	FPicrossLineCache Cache(CandidateCacheBytes);
+	FPicrossVerifierOptions Options = FPicrossDifficultyRater::MakeVerifierOptions(&Cache, false);
+	Options.TimeLimitSeconds = Settings.VerifierTimeLimitSeconds;
+
+	TArray<bool>& Solution = OutPuzzle.Solution;
+	for (; OutPuzzle.Adjustments <= Settings.MaxAdjustments; ++OutPuzzle.Adjustments)
+	{
+		FPicrossPuzzleClues Clues;
+		if (!Clues.Generate(Settings.GridSize, Solution)) break;
+
+		int32 CellToFlip = INDEX_NONE;
+		const FPicrossUniquenessResult Uniqueness = FPicrossUniquenessVerifier::Verify(Clues, Options);
+		if (Uniqueness.Result == EPicrossUniqueness::Multiple)
+		{
+			// The cells the two solutions disagree on are the ones the clues can't pin down, changing one of them changes the clues right where they are ambiguous.
+			const TArray<int32> AmbiguousCells = Uniqueness.GetAmbiguousCells();
+			CellToFlip = AmbiguousCells[Stream.RandHelper(AmbiguousCells.Num())];
+		}
+		else if (Uniqueness.Result == EPicrossUniqueness::Unique)
+		{
+			OutPuzzle.Rating = FPicrossDifficultyRater::Rate(Uniqueness, Settings.GridSize);
+			const bool bTooEasy = OutPuzzle.Rating.Score < Settings.MinDifficulty;
+			const bool bTooHard = Settings.MaxDifficulty >= 0.f && OutPuzzle.Rating.Score > Settings.MaxDifficulty;
+			if (!bTooEasy && !bTooHard) return true;
+
+			// Sparser puzzles leave more room for placing the blocks and are harder to deduce, denser ones are easier.
+			CellToFlip = PickCell(Solution, bTooEasy, Stream);
+		}
+
+		// Undetermined candidates are too expensive to adjust, a fresh seed is cheaper.
+		if (CellToFlip == INDEX_NONE) break;
+		Solution[CellToFlip] = !Solution[CellToFlip];
+	}
+
+	OutPuzzle.Solution.Reset();
+	return false;
+}
+
+TArray<FPicrossGeneratedPuzzle> FPicrossPuzzleGenerator::GenerateMany(TArrayView<const FPicrossGeneratorSettings> Settings, int32 Seed, int32 FirstIndex, int32 MaxAttempts)
+{
+	TArray<FPicrossGeneratedPuzzle> Puzzles;
+	Puzzles.SetNum(Settings.Num());
+	ParallelFor(Settings.Num(), [&](int32 Index)
+	{
+		for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+		{
+			const int32 CandidateSeed = static_cast<int32>(HashCombine(GetTypeHash(Seed), HashCombine(GetTypeHash(FirstIndex + Index), GetTypeHash(Attempt))));
+			if (Generate(Settings[Index], CandidateSeed, Puzzles[Index])) break;
+		}
+	});
+	return Puzzles;
+}
@@ -0,0 +1,66 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PicrossDifficultyRater.h"
+
+enum class EPicrossGeneratorShape : uint8
+{
+	// Every cell is picked independently.
+	Random,
+	// Smooth value noise, gives connected blobs that look more like objects.
+	Noise
+};
+
+struct PICROSS_API FPicrossGeneratorSettings
+{
+	FIntVector GridSize = FIntVector(10);
+	// Fraction of the cells that start out filled, the adjustments move it a little.
+	float Density = 0.5f;
+	EPicrossGeneratorShape Shape = EPicrossGeneratorShape::Noise;
+	// Distance in cells between the lattice points of the noise, larger gives bigger blobs.
+	float NoiseScale = 4.f;
+	float MinDifficulty = 0.f;
+	// Negative means no upper bound.
+	float MaxDifficulty = -1.f;
+	// Number of cells that may be flipped before a candidate is given up on.
+	int32 MaxAdjustments = 64;
+	// A candidate whose uniqueness can't be decided within this many seconds is given up on.
+	double VerifierTimeLimitSeconds = 5.0;
+};
+
+struct PICROSS_API FPicrossGeneratedPuzzle
+{
+	FIntVector GridSize = FIntVector::ZeroValue;
+	// In MasterIndex order, empty if generation failed.
+	TArray<bool> Solution;
+	FPicrossDifficultyRating Rating;
+	// Cells flipped to make the solution unique and to get it into the difficulty band.
+	int32 Adjustments = 0;
+	int32 Seed = 0;
+};
+
+/**
+ * Generates puzzles whose clues have exactly one solution.
+ * A random solution is adjusted with feedback from the uniqueness verifier, flipping cells the found solutions disagree on until only one is left, and then from the difficulty rating.
+ * The same settings and seed always give the same puzzle as long as no uniqueness check runs out of time.
+ */
+class PICROSS_API FPicrossPuzzleGenerator
+{
+public:
+	FPicrossPuzzleGenerator() = delete;
+
+	/**
+	 * Generates a single puzzle on the calling thread.
+	 * @returns false if the candidate couldn't be adjusted into a unique puzzle within the difficulty band, try another seed.
+	 */
+	static bool Generate(const FPicrossGeneratorSettings& Settings, int32 Seed, FPicrossGeneratedPuzzle& OutPuzzle);
+
+	/**
+	 * Generates one puzzle per settings in parallel, trying up to MaxAttempts seeds for each.
+	 * The seeds tried for puzzle I only depend on Seed and FirstIndex + I, so a long run can be split into batches without changing the puzzles.
+	 * @returns the puzzles in the order of the settings, the ones that failed every attempt have an empty solution.
+	 */
+	static TArray<FPicrossGeneratedPuzzle> GenerateMany(TArrayView<const FPicrossGeneratorSettings> Settings, int32 Seed, int32 FirstIndex = 0, int32 MaxAttempts = 16);
+};
@@ -0,0 +1,373 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossUniquenessVerifier.h"
+#include "../PicrossBlock.h"
+#include "../PicrossPuzzleData.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/UniquePtr.h"
+
+namespace
+{
+	/**
+	 * A branch of the search tree, the grid as it was when branching and the value to try for the branching cell.
+	 */
+	struct FSearchNode
+	{
+		FPicrossSolverGrid Grid;
+		FIntVector Cell;
+		bool bFilled;
+	};
+
+	/**
+	 * The nodes of a single worker. The owner works depth-first from the back while thieves take the oldest, and therefore largest, branches from the front.
+	 */
+	struct FWorkerQueue
+	{
+		FCriticalSection Lock;
+		TArray<FSearchNode> Nodes;
+	};
+
+	/**
+	 * Picks the first unknown cell of the line with the fewest unknown cells, branching there narrows the search the most.
+	 * @param bOutFilledFirst - Whether filled is the likelier value, based on how many of the unknown cells of the line still have to be filled.
+	 */
+	bool FindBranchCell(const FPicrossSolverGrid& Grid, const FPicrossPuzzleClues& Clues, FIntVector& OutCell, bool& bOutFilledFirst)
+	{
+		const FPicrossLineLayout& Layout = Grid.GetLayout(EAxis::X);
+		int32 BestLine = INDEX_NONE;
+		int32 BestUnknown = MAX_int32;
+		for (int32 LineIndex = 0; LineIndex < Layout.Num() && BestUnknown > 1; ++LineIndex)
+		{
+			const FPicrossLineState& Line = Grid.GetLine(EAxis::X, LineIndex);
+			const int32 Unknown = Layout.Length - (Line.Filled | Line.Empty).CountSetBits();
+			if (Unknown > 0 && Unknown < BestUnknown)
+			{
+				BestUnknown = Unknown;
+				BestLine = LineIndex;
+			}
+		}
+		if (BestLine == INDEX_NONE) return false;
+
+		const FPicrossLineState& Line = Grid.GetLine(EAxis::X, BestLine);
+		const FPicrossLineMask Unknown = ~(Line.Filled | Line.Empty);
+		OutCell = Layout.ToXYZ(BestLine, Unknown.FindFirstSetBit(0, Layout.Length));
+
+		int32 FilledCells = 0;
+		for (const uint16 Run : Clues.GetClue(EAxis::X, BestLine))
+		{
+			FilledCells += Run;
+		}
+		bOutFilledFirst = (FilledCells - Line.Filled.CountSetBits()) * 2 > BestUnknown;
+		return true;
+	}
+
+	class FSearch
+	{
+	public:
+		FSearch(const FPicrossPuzzleClues& Clues, FPicrossLineCache* Cache, const FPicrossVerifierOptions& InOptions, double StartTime)
+			: Solver(Clues)
+			, Options(InOptions)
+			, Deadline(InOptions.TimeLimitSeconds > 0.0 ? StartTime + InOptions.TimeLimitSeconds : 0.0)
+		{
+			Solver.SetParallel(false);
+			Solver.SetCache(Cache);
+			WorkAvailable = FPlatformProcess::GetSynchEventFromPool(false);
+		}
+		~FSearch()
+		{
+			FPlatformProcess::ReturnSynchEventToPool(WorkAvailable);
+		}
+
+		/**
+		 * Searches every branch below a propagated root until the tree is exhausted or two solutions are found.
+		 */
+		void Run(const FPicrossSolverGrid& Root, int32 NumWorkers)
+		{
+			for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; ++WorkerIndex)
+			{
+				Queues.Add(MakeUnique<FWorkerQueue>());
+			}
+
+			FIntVector Cell;
+			bool bFilledFirst;
+			if (FindBranchCell(Root, Solver.GetClues(), Cell, bFilledFirst))
+			{
+				Decisions.Increment();
+				PendingNodes.Add(2);
+				Queues[0]->Nodes.Add(FSearchNode{ Root, Cell, !bFilledFirst });
+				Queues[0]->Nodes.Add(FSearchNode{ Root, Cell, bFilledFirst });
+			}
+
+			ParallelFor(NumWorkers, [this](int32 WorkerIndex) { WorkerLoop(WorkerIndex); });
+		}
+
+		// Whether the search stopped before the tree was exhausted without finding a second solution.
+		bool WasInterrupted() const { return bInterrupted; }
+		const TArray<TArray<EBlockState>>& GetSolutions() const { return Solutions; }
+		const FPicrossSolverStats& GetStats() const { return Stats; }
+		int64 GetDecisions() const { return Decisions.GetValue(); }
+
+	private:
+		void WorkerLoop(int32 WorkerIndex)
+		{
+			FPicrossLineWorklist Worklist;
+			Worklist.Init(Solver.GetClues().GridSize);
+			FPicrossSolverStats WorkerStats;
+
+			FSearchNode Node;
+			while (!ShouldStop())
+			{
+				if (PopOrSteal(WorkerIndex, Node))
+				{
+					Explore(WorkerIndex, Node, Worklist, WorkerStats);
+					if (PendingNodes.Decrement() == 0)
+					{
+						WorkAvailable->Trigger();
+					}
+				}
+				else if (PendingNodes.GetValue() == 0)
+				{
+					break;
+				}
+				else
+				{
+					// Parks until a node is pushed or the search ends, the timeout only bounds how late a cancel or the deadline is noticed.
+					WorkAvailable->Wait(IdleWaitMilliseconds);
+				}
+			}
+
+			// The event wakes one worker at a time, every worker leaving wakes the next so none stays parked after the search ends.
+			WorkAvailable->Trigger();
+
+			FScopeLock ScopeLock(&ResultLock);
+			Stats += WorkerStats;
+		}
+
+		bool PopOrSteal(int32 WorkerIndex, FSearchNode& OutNode)
+		{
+			{
+				FWorkerQueue& Own = *Queues[WorkerIndex];
+				FScopeLock ScopeLock(&Own.Lock);
+				if (Own.Nodes.Num() > 0)
+				{
+					OutNode = Own.Nodes.Pop(false);
+					return true;
+				}
+			}
+
+			for (int32 Offset = 1; Offset < Queues.Num(); ++Offset)
+			{
+				FWorkerQueue& Victim = *Queues[(WorkerIndex + Offset) % Queues.Num()];
+				FScopeLock ScopeLock(&Victim.Lock);
+				if (Victim.Nodes.Num() > 0)
+				{
+					OutNode = MoveTemp(Victim.Nodes[0]);
+					Victim.Nodes.RemoveAt(0, 1, false);
+					// Pushes that happened while nobody was parked collapse into one signal, so a thief passes it on in case more nodes are waiting.
+					if (Victim.Nodes.Num() > 0)
+					{
+						WorkAvailable->Trigger();
+					}
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Follows one branch depth-first, leaving the other value of every branching cell on the queue for later or for other workers.
+		void Explore(int32 WorkerIndex, FSearchNode& Node, FPicrossLineWorklist& Worklist, FPicrossSolverStats& WorkerStats)
+		{
+			FPicrossSolverGrid& Grid = Node.Grid;
+			FIntVector Cell = Node.Cell;
+			bool bFilled = Node.bFilled;
+
+			while (!ShouldStop() && Grid.SetCell(Cell, bFilled, &Worklist))
+			{
+				const EPicrossSolveResult Result = Solver.Propagate(Grid, Worklist, &WorkerStats);
+				if (Result == EPicrossSolveResult::Contradiction) return;
+				if (Result == EPicrossSolveResult::Solved)
+				{
+					RecordSolution(Grid);
+					return;
+				}
+				bool bFilledFirst;
+				if (!FindBranchCell(Grid, Solver.GetClues(), Cell, bFilledFirst)) return;
+
+				Decisions.Increment();
+				PendingNodes.Increment();
+				{
+					FWorkerQueue& Own = *Queues[WorkerIndex];
+					FScopeLock ScopeLock(&Own.Lock);
+					Own.Nodes.Add(FSearchNode{ Grid, Cell, !bFilledFirst });
+				}
+				WorkAvailable->Trigger();
+				bFilled = bFilledFirst;
+			}
+		}
+
+		void RecordSolution(const FPicrossSolverGrid& Grid)
+		{
+			FScopeLock ScopeLock(&ResultLock);
+			if (Solutions.Num() < 2)
+			{
+				Grid.ToBlockStates(Solutions.AddDefaulted_GetRef());
+			}
+			if (Solutions.Num() >= 2)
+			{
+				bFinished = true;
+				WorkAvailable->Trigger();
+			}
+		}
+
+		bool ShouldStop()
+		{
+			if (bFinished) return true;
+
+			const bool bCancelled = Options.CancelFlag && *Options.CancelFlag;
+			const bool bOutOfTime = Deadline > 0.0 && FPlatformTime::Seconds() > Deadline;
+			const bool bOutOfDecisions = Options.MaxDecisions > 0 && Decisions.GetValue() > Options.MaxDecisions;
+			if (bCancelled || bOutOfTime || bOutOfDecisions)
+			{
+				bInterrupted = true;
+				bFinished = true;
+			}
+			return bFinished;
+		}
+
+		FPicrossGridSolver Solver;
+		const FPicrossVerifierOptions& Options;
+		const double Deadline;
+
+		static constexpr uint32 IdleWaitMilliseconds = 10;
+
+		TArray<TUniquePtr<FWorkerQueue>> Queues;
+		// Signalled when a node is pushed or the search ends, idle workers wait on it instead of spinning.
+		FEvent* WorkAvailable = nullptr;
+		// Nodes that are queued or being explored, the search is exhausted when this reaches 0.
+		FThreadSafeCounter PendingNodes;
+		FThreadSafeBool bFinished;
+		FThreadSafeBool bInterrupted;
+
+		FCriticalSection ResultLock;
+		TArray<TArray<EBlockState>> Solutions;
+		FPicrossSolverStats Stats;
+		// Shared by the workers so the decision budget covers the whole search.
+		FThreadSafeCounter64 Decisions;
+	};
+}
+
+TArray<int32> FPicrossUniquenessResult::GetAmbiguousCells() const
+{
+	TArray<int32> AmbiguousCells;
+	if (Solution.Num() == Witness.Num())
+	{
+		for (int32 Index = 0; Index < Solution.Num(); ++Index)
+		{
+			if (Solution[Index] != Witness[Index])
+			{
+				AmbiguousCells.Add(Index);
+			}
+		}
+	}
+	return AmbiguousCells;
+}
+
+FPicrossUniquenessResult FPicrossUniquenessVerifier::Verify(const FPicrossPuzzleClues& Clues, const FPicrossVerifierOptions& Options)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FPicrossUniquenessResult Result;
+
+	TUniquePtr<FPicrossLineCache> LocalCache;
+	FPicrossLineCache* Cache = Options.Cache;
+	if (!Cache)
+	{
+		LocalCache = MakeUnique<FPicrossLineCache>();
+		Cache = LocalCache.Get();
+	}
+	const FPicrossLineCacheStats CacheStatsBefore = Cache->GetStats();
+
+	// The root is propagated and probed wide before the search splits into one serial propagation per worker.
+	FPicrossGridSolver RootSolver(Clues);
+	RootSolver.SetParallel(Options.bParallelRoot);
+	RootSolver.SetCache(Cache);
+	FPicrossSolverGrid Root;
+	RootSolver.InitGrid(Root);
+	EPicrossSolveResult RootResult = RootSolver.Propagate(Root, &Result.Stats);
+	Result.RootSweeps = Result.Stats.Sweeps;
+	if (RootResult == EPicrossSolveResult::Stalled && Options.bProbe)
+	{
+		const int32 KnownCells = Root.CountKnownCells();
+		FPicrossProber Prober(RootSolver);
+		Prober.SetParallel(Options.bParallelRoot);
+		Prober.SetDeadline(Options.TimeLimitSeconds > 0.0 ? StartTime + Options.TimeLimitSeconds : 0.0);
+		RootResult = Prober.Solve(Root, &Result.ProbeStats, Options.CancelFlag);
+		Result.RootProbedCells = Root.CountKnownCells() - KnownCells;
+	}
+
+	if (RootResult == EPicrossSolveResult::Contradiction)
+	{
+		Result.Result = EPicrossUniqueness::Unsolvable;
+	}
+	else if (RootResult == EPicrossSolveResult::Solved)
+	{
+		Result.Result = EPicrossUniqueness::Unique;
+		Root.ToBlockStates(Result.Solution);
+	}
+	else
+	{
+		// ParallelFor runs its bodies on the task graph workers and the calling thread, more bodies than that would only wait for a free thread.
+		const int32 NumWorkers = Options.NumWorkers > 0 ? Options.NumWorkers : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+		FSearch Search(Clues, Cache, Options, StartTime);
+		Search.Run(Root, FMath::Max(NumWorkers, 1));
+
+		const TArray<TArray<EBlockState>>& Solutions = Search.GetSolutions();
+		if (Solutions.Num() > 0)
+		{
+			Result.Solution = Solutions[0];
+		}
+
+		if (Solutions.Num() >= 2)
+		{
+			Result.Result = EPicrossUniqueness::Multiple;
+			Result.Witness = Solutions[1];
+		}
+		else if (Search.WasInterrupted())
+		{
+			Result.Result = EPicrossUniqueness::Undetermined;
+		}
+		else
+		{
+			Result.Result = Solutions.Num() == 1 ? EPicrossUniqueness::Unique : EPicrossUniqueness::Unsolvable;
+		}
+
+		Result.Stats += Search.GetStats();
+		Result.Decisions = Search.GetDecisions();
+	}
+
+	// A shared cache may have counted other runs before this one, only the difference belongs to this run.
+	Result.CacheStats = Cache->GetStats();
+	Result.CacheStats.Hits -= CacheStatsBefore.Hits;
+	Result.CacheStats.Misses -= CacheStatsBefore.Misses;
+	Result.CacheStats.Evictions -= CacheStatsBefore.Evictions;
+
+	Result.Stats.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	return Result;
+}
+
+bool FPicrossUniquenessVerifier::Verify(const UPicrossPuzzleData& PuzzleData, FPicrossUniquenessResult& OutResult, const FPicrossVerifierOptions& Options)
+{
+	FPicrossPuzzleClues Clues;
+	if (!Clues.Generate(PuzzleData)) return false;
+
+	OutResult = Verify(Clues, Options);
+	return true;
+}
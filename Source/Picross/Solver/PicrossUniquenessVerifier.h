@@ -0,0 +1,79 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "PicrossGridSolver.h"
+#include "PicrossLineCache.h"
+#include "PicrossProber.h"
+
+enum class EPicrossUniqueness : uint8
+{
+	// The clues have exactly one solution.
+	Unique,
+	// The clues have more than one solution, see the witness.
+	Multiple,
+	// The clues have no solution.
+	Unsolvable,
+	// The search was cancelled or ran out of time before it could decide.
+	Undetermined
+};
+
+struct PICROSS_API FPicrossVerifierOptions
+{
+	// Number of worker threads searching the tree, 0 uses one per task graph worker plus the calling thread.
+	int32 NumWorkers = 0;
+	// Gives up with Undetermined after this many seconds, 0 means no limit.
+	double TimeLimitSeconds = 0.0;
+	// Gives up with Undetermined after this many branches, 0 means no limit. Unlike the time limit it stops a single worker at the same point on every machine.
+	int64 MaxDecisions = 0;
+	// Optional flag another thread can raise to cancel the search.
+	const FThreadSafeBool* CancelFlag = nullptr;
+	// Whether to probe the root before branching, most 3D puzzles that stall on propagation are settled by probing alone.
+	bool bProbe = true;
+	// Whether propagating and probing the root may go wide, turn off when verifying several puzzles at once.
+	bool bParallelRoot = true;
+	// Optional cache of solved lines to share with other runs, each run uses a cache of its own when this is null.
+	FPicrossLineCache* Cache = nullptr;
+};
+
+struct PICROSS_API FPicrossUniquenessResult
+{
+	EPicrossUniqueness Result = EPicrossUniqueness::Undetermined;
+	// The first solution found, in MasterIndex order.
+	TArray<EBlockState> Solution;
+	// A second solution proving the clues are ambiguous, only set for Multiple.
+	TArray<EBlockState> Witness;
+	// Number of branches taken on undecided cells.
+	int64 Decisions = 0;
+	// Propagation sweeps before the root was solved or stalled, before any probing.
+	int32 RootSweeps = 0;
+	// Cells of the root that were only deduced by probing.
+	int64 RootProbedCells = 0;
+	FPicrossSolverStats Stats;
+	FPicrossProbeStats ProbeStats;
+	FPicrossLineCacheStats CacheStats;
+
+	/**
+	 * Gets the cells that differ between the solution and the witness, in MasterIndex order.
+	 */
+	TArray<int32> GetAmbiguousCells() const;
+};
+
+/**
+ * Decides whether the clues of a puzzle have exactly one solution.
+ * Combines propagation with branching on undecided cells, spreading the search tree over worker threads that steal work from each other and stopping once a second solution is found.
+ */
+class PICROSS_API FPicrossUniquenessVerifier
+{
+public:
+	FPicrossUniquenessVerifier() = delete;
+
+	static FPicrossUniquenessResult Verify(const FPicrossPuzzleClues& Clues, const FPicrossVerifierOptions& Options = FPicrossVerifierOptions());
+	/**
+	 * Verifies the clues generated from the solution of the puzzle.
+	 * @returns false if the puzzle isn't valid.
+	 */
+	static bool Verify(const UPicrossPuzzleData& PuzzleData, FPicrossUniquenessResult& OutResult, const FPicrossVerifierOptions& Options = FPicrossVerifierOptions());
+};
@@ -11,16 +11,40 @@
 
 
 TArray<UAssetDataObject*> UPuzzleBrowserWidget::GetPuzzles()
+{
+	TArray<UAssetDataObject*> AssetDataObjects = CreateAssetDataObjects(GetPuzzleDatas());
+
+	Algo::Sort(AssetDataObjects, [](UAssetDataObject* A, UAssetDataObject* B) { return (A && B) ? (FArray3D::Size64(A->GetGridSize()) < FArray3D::Size64(B->GetGridSize())) : false; });
+	return AssetDataObjects;
+}
+
+TArray<UAssetDataObject*> UPuzzleBrowserWidget::GetPuzzlesByDifficulty(float MinDifficulty, float MaxDifficulty)
+{
+	TArray<UAssetDataObject*> AssetDataObjects = CreateAssetDataObjects(GetPuzzleDatas());
+	AssetDataObjects.RemoveAll([MinDifficulty, MaxDifficulty](UAssetDataObject* AssetDataObject)
+	{
+		const float Difficulty = AssetDataObject->GetDifficulty();
+		return Difficulty < 0.f || Difficulty < MinDifficulty || (MaxDifficulty >= 0.f && Difficulty > MaxDifficulty);
+	});
+
+	Algo::Sort(AssetDataObjects, [](UAssetDataObject* A, UAssetDataObject* B)
+	{
+		const float DifficultyA = A->GetDifficulty();
+		const float DifficultyB = B->GetDifficulty();
+		return DifficultyA != DifficultyB ? DifficultyA < DifficultyB : FArray3D::Size64(A->GetGridSize()) < FArray3D::Size64(B->GetGridSize());
+	});
+	return AssetDataObjects;
+}
+
+TArray<UAssetDataObject*> UPuzzleBrowserWidget::CreateAssetDataObjects(const TArray<FAssetData>& AssetDatas)
 {
 	TArray<UAssetDataObject*> AssetDataObjects;
-	for (FAssetData AssetData : GetPuzzleDatas())
+	for (const FAssetData& AssetData : AssetDatas)
 	{
 		UAssetDataObject* AssetDataObject = NewObject<UAssetDataObject>(this, UAssetDataObject::StaticClass());
 		AssetDataObject->SetAssetData(AssetData);
 		AssetDataObjects.Push(AssetDataObject);
 	}
-
-	Algo::Sort(AssetDataObjects, [](UAssetDataObject* A, UAssetDataObject* B) { return (A && B) ? (FArray3D::Size(A->GetGridSize()) < FArray3D::Size(B->GetGridSize())) : false; });
 	return AssetDataObjects;
 }
 
@@ -19,7 +19,14 @@ class PICROSS_API UPuzzleBrowserWidget : public UUserWidget
 protected:
 	UFUNCTION(BlueprintCallable, Category = "Picross")
 	TArray<class UAssetDataObject*> GetPuzzles();
+	/**
+	 * Gets the rated puzzles with a difficulty within [MinDifficulty, MaxDifficulty] sorted from easiest to hardest, read from the asset registry without loading the puzzles.
+	 * @param MaxDifficulty - Negative means no upper bound.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Picross")
+	TArray<class UAssetDataObject*> GetPuzzlesByDifficulty(float MinDifficulty = 0.f, float MaxDifficulty = -1.f);
 
 private:
 	TArray<FAssetData> GetPuzzleDatas() const;
+	TArray<class UAssetDataObject*> CreateAssetDataObjects(const TArray<FAssetData>& AssetDatas);
 };
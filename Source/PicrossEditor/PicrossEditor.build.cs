@@ -12,7 +12,7 @@ public class PicrossEditor : ModuleRules
 
         PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "Picross", "Array3D", "UnrealEd" });
 
-        PrivateDependencyModuleNames.AddRange(new string[] {  });
+        PrivateDependencyModuleNames.AddRange(new string[] { "Json" });
 
         PublicIncludePaths.AddRange(
             new string[]
@@ -0,0 +1,421 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossBenchmarkCommandlet.h"
+#include "PicrossEditor.h"
+#include "Picross/PicrossBlock.h"
+#include "Picross/Solver/PicrossGridDispatch.h"
+#include "Picross/Solver/PicrossGridSolver.h"
+#include "FArray3D.h"
+#include "Math/RandomStream.h"
+#include "TArray3D.h"
+
+namespace
+{
+	/**
+	 * Runs the body Iterations times.
+	 * @returns the fastest run in milliseconds, the fastest is the one least disturbed by the rest of the machine.
+	 */
+	double TimeBest(int32 Iterations, TFunctionRef<int64()> Body, int64& OutSum)
+	{
+		double Best = TNumericLimits<double>::Max();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			OutSum = Body();
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - StartTime);
+		}
+		return Best * 1000.0;
+	}
+
+	/**
+	 * Times both ways of visiting the same cells and logs the result.
+	 * @returns false if the two ways didn't visit the same cells.
+	 */
+	bool RunCase(const TCHAR* Name, int32 Iterations, TFunctionRef<int64()> Lookup, TFunctionRef<int64()> View)
+	{
+		int64 LookupSum = 0, ViewSum = 0;
+		const double LookupTime = TimeBest(Iterations, Lookup, LookupSum);
+		const double ViewTime = TimeBest(Iterations, View, ViewSum);
+		UE_LOG(PicrossEditor, Display, TEXT("%-10s lookup %8.3fms  view %8.3fms  %5.1fx"), Name, LookupTime, ViewTime, LookupTime / FMath::Max(ViewTime, 1e-6));
+
+		if (LookupSum != ViewSum)
+		{
+			UE_LOG(PicrossEditor, Error, TEXT("%s: the sums don't match (%lld vs %lld)."), Name, LookupSum, ViewSum);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Gets the cell at AxisIndex along Axis, U and V are the remaining axes in storage order like in TArray3DSlice.
+	 */
+	FIntVector ToXYZ(EAxis::Type Axis, int32 AxisIndex, int32 U, int32 V)
+	{
+		return Axis == EAxis::X ? FIntVector(AxisIndex, U, V) : Axis == EAxis::Y ? FIntVector(U, AxisIndex, V) : FIntVector(U, V, AxisIndex);
+	}
+
+	/**
+	 * Times scanning every line and every slice along every axis and filling the middle half of a Size^3 grid stored in the given layout.
+	 * @param OutChecksum - The sum of the line and slice scans, the same for every layout when they visit the same cells.
+	 */
+	template<typename LayoutType>
+	void BenchmarkLayout(const TCHAR* Name, int32 Size, int32 Iterations, int64& OutChecksum)
+	{
+		TArray3D<int32, LayoutType> Grid;
+		if (!Grid.Init(FIntVector(Size))) return;
+
+		const typename TArray3D<int32, LayoutType>::BoxType Cells = Grid.GetBox();
+		for (auto It = Cells.begin(); It != Cells.end(); ++It)
+		{
+			const FIntVector XYZ = It.GetPosition();
+			*It = (XYZ.X * 7 + XYZ.Y * 13 + XYZ.Z * 29) & 0xFF;
+		}
+
+		const EAxis::Type Axes[] = { EAxis::X, EAxis::Y, EAxis::Z };
+		int64 LineSum = 0, SliceSum = 0, FillSum = 0;
+		const double LineTime = TimeBest(Iterations, [&]()
+		{
+			int64 Sum = 0;
+			for (const EAxis::Type Axis : Axes)
+			{
+				for (int32 V = 0; V < Size; ++V)
+				{
+					for (int32 U = 0; U < Size; ++U)
+					{
+						for (const int32 Cell : Grid.GetLine(Axis, ToXYZ(Axis, 0, U, V)))
+						{
+							Sum += Cell;
+						}
+					}
+				}
+			}
+			return Sum;
+		}, LineSum);
+
+		const double SliceTime = TimeBest(Iterations, [&]()
+		{
+			int64 Sum = 0;
+			for (const EAxis::Type Axis : Axes)
+			{
+				for (int32 AxisIndex = 0; AxisIndex < Size; ++AxisIndex)
+				{
+					for (const int32 Cell : Grid.GetSlice(Axis, AxisIndex))
+					{
+						Sum += Cell;
+					}
+				}
+			}
+			return Sum;
+		}, SliceSum);
+
+		const FIntVector Min(Size / 4), Max(Size - Size / 4 - 1);
+		const double FillTime = TimeBest(Iterations, [&]()
+		{
+			int64 Filled = 0;
+			for (int32& Cell : Grid.GetBox(Min, Max))
+			{
+				Cell = 0;
+				++Filled;
+			}
+			return Filled;
+		}, FillSum);
+
+		UE_LOG(PicrossEditor, Display, TEXT("%4d^3 %-9s lines %8.3fms  slices %8.3fms  fill %8.3fms"), Size, Name, LineTime, SliceTime, FillTime);
+		OutChecksum = LineSum + SliceSum;
+	}
+
+	/**
+	 * Times generating the clues of a random puzzle and propagating them on an empty grid, once with the index math for the size from FPicrossGridDispatch and once with the generic one.
+	 * Small puzzles are repeated so every run takes about as long as one 15^3 puzzle.
+	 * @returns false if the two didn't produce the same clues and the same grid.
+	 */
+	bool BenchmarkDispatch(FIntVector GridSize, int32 Iterations)
+	{
+		FRandomStream Stream(FArray3D::Size(GridSize));
+		TArray<bool> Solution;
+		Solution.Reserve(FArray3D::Size(GridSize));
+		for (int32 Index = 0; Index < FArray3D::Size(GridSize); ++Index)
+		{
+			Solution.Add(Stream.FRand() < 0.6f);
+		}
+		const int32 Repeats = FMath::Max(1, 3375 / Solution.Num());
+
+		double GenerateTimes[2], PropagateTimes[2];
+		FPicrossPuzzleClues Clues[2];
+		TArray<EBlockState> States[2];
+		const bool bWasEnabled = FPicrossGridDispatch::AreFixedSizesEnabled();
+		for (int32 Pass = 0; Pass < 2; ++Pass)
+		{
+			FPicrossGridDispatch::SetFixedSizesEnabled(Pass == 0);
+			int64 Sum = 0;
+			GenerateTimes[Pass] = TimeBest(Iterations, [&]()
+			{
+				for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+				{
+					Clues[Pass].Generate(GridSize, Solution);
+				}
+				return int64(0);
+			}, Sum);
+
+			FPicrossGridSolver Solver(Clues[Pass]);
+			Solver.SetParallel(false);
+			FPicrossSolverGrid Grid;
+			PropagateTimes[Pass] = TimeBest(Iterations, [&]()
+			{
+				for (int32 Repeat = 0; Repeat < Repeats; ++Repeat)
+				{
+					Solver.InitGrid(Grid);
+					Solver.Propagate(Grid);
+				}
+				return int64(0);
+			}, Sum);
+			Grid.ToBlockStates(States[Pass]);
+		}
+		FPicrossGridDispatch::SetFixedSizesEnabled(bWasEnabled);
+
+		UE_LOG(PicrossEditor, Display, TEXT("%2dx%2dx%2d x%-4d clues fixed %7.3fms generic %7.3fms %4.2fx  propagate fixed %7.3fms generic %7.3fms %4.2fx"),
+			GridSize.X, GridSize.Y, GridSize.Z, Repeats,
+			GenerateTimes[0], GenerateTimes[1], GenerateTimes[1] / FMath::Max(GenerateTimes[0], 1e-6),
+			PropagateTimes[0], PropagateTimes[1], PropagateTimes[1] / FMath::Max(PropagateTimes[0], 1e-6));
+
+		const bool bSame = States[0] == States[1] && Clues[0] == Clues[1];
+		if (!bSame)
+		{
+			UE_LOG(PicrossEditor, Error, TEXT("%dx%dx%d: the fixed and generic index math don't give the same result."), GridSize.X, GridSize.Y, GridSize.Z);
+		}
+		return bSame;
+	}
+}
+
+UPicrossBenchmarkCommandlet::UPicrossBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPicrossBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 Size = 64;
+	int32 Iterations = 20;
+	FParse::Value(*Params, TEXT("Size="), Size);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+
+	const FIntVector Dimensions(Size);
+	TArray3D<int32> Grid;
+	if (!Grid.Init(Dimensions)) return 1;
+
+	int32 Value = 0;
+	for (int32& Cell : Grid)
+	{
+		Cell = Value++ & 0xFF;
+	}
+	const TArray<int32>& Cells = Grid.GetArray();
+	const EAxis::Type Axes[] = { EAxis::X, EAxis::Y, EAxis::Z };
+
+	UE_LOG(PicrossEditor, Display, TEXT("Benchmarking a %d^3 grid, best of %d."), Size, Iterations);
+	bool bPassed = true;
+
+	// Every cell.
+	bPassed &= RunCase(TEXT("Grid"), Iterations, [&]()
+	{
+		int64 Sum = 0;
+		for (int32 Z = 0; Z < Size; ++Z)
+		{
+			for (int32 Y = 0; Y < Size; ++Y)
+			{
+				for (int32 X = 0; X < Size; ++X)
+				{
+					Sum += Cells[FArray3D::TranslateTo1D(Dimensions, FIntVector(X, Y, Z))];
+				}
+			}
+		}
+		return Sum;
+	}, [&]()
+	{
+		int64 Sum = 0;
+		for (const int32 Cell : Grid)
+		{
+			Sum += Cell;
+		}
+		return Sum;
+	});
+
+	// Every line along every axis, the way the numbers and the highlight walk the grid.
+	bPassed &= RunCase(TEXT("Lines"), Iterations, [&]()
+	{
+		int64 Sum = 0;
+		for (const EAxis::Type Axis : Axes)
+		{
+			for (int32 V = 0; V < Size; ++V)
+			{
+				for (int32 U = 0; U < Size; ++U)
+				{
+					for (int32 AxisIndex = 0; AxisIndex < Size; ++AxisIndex)
+					{
+						Sum += Cells[FArray3D::TranslateTo1D(Dimensions, ToXYZ(Axis, AxisIndex, U, V))];
+					}
+				}
+			}
+		}
+		return Sum;
+	}, [&]()
+	{
+		int64 Sum = 0;
+		for (const EAxis::Type Axis : Axes)
+		{
+			for (int32 V = 0; V < Size; ++V)
+			{
+				for (int32 U = 0; U < Size; ++U)
+				{
+					for (const int32 Cell : Grid.GetLine(Axis, ToXYZ(Axis, 0, U, V)))
+					{
+						Sum += Cell;
+					}
+				}
+			}
+		}
+		return Sum;
+	});
+
+	// Every slice along every axis, the way the rotation axes show one layer of the grid.
+	bPassed &= RunCase(TEXT("Slices"), Iterations, [&]()
+	{
+		int64 Sum = 0;
+		for (const EAxis::Type Axis : Axes)
+		{
+			for (int32 AxisIndex = 0; AxisIndex < Size; ++AxisIndex)
+			{
+				for (int32 V = 0; V < Size; ++V)
+				{
+					for (int32 U = 0; U < Size; ++U)
+					{
+						Sum += Cells[FArray3D::TranslateTo1D(Dimensions, ToXYZ(Axis, AxisIndex, U, V))];
+					}
+				}
+			}
+		}
+		return Sum;
+	}, [&]()
+	{
+		int64 Sum = 0;
+		for (const EAxis::Type Axis : Axes)
+		{
+			for (int32 AxisIndex = 0; AxisIndex < Size; ++AxisIndex)
+			{
+				for (const int32 Cell : Grid.GetSlice(Axis, AxisIndex))
+				{
+					Sum += Cell;
+				}
+			}
+		}
+		return Sum;
+	});
+
+	// The middle half of the grid, the way a drag selects a box of blocks.
+	const FIntVector Min(Size / 4), Max(Size - Size / 4 - 1);
+	bPassed &= RunCase(TEXT("Box"), Iterations, [&]()
+	{
+		int64 Sum = 0;
+		for (int32 Z = Min.Z; Z <= Max.Z; ++Z)
+		{
+			for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			{
+				for (int32 X = Min.X; X <= Max.X; ++X)
+				{
+					Sum += Cells[FArray3D::TranslateTo1D(Dimensions, FIntVector(X, Y, Z))];
+				}
+			}
+		}
+		return Sum;
+	}, [&]()
+	{
+		int64 Sum = 0;
+		for (const int32 Cell : Grid.GetBox(Min, Max))
+		{
+			Sum += Cell;
+		}
+		return Sum;
+	});
+
+	// Every index of the grid in a shuffled order, the way undo replay, save loading and instance rebuilds convert indices in bulk.
+	{
+		TArray<int32> Indices;
+		Indices.Reserve(Cells.Num());
+		for (int32 Index = 0; Index < Cells.Num(); ++Index)
+		{
+			Indices.Add(Index);
+		}
+		FRandomStream Stream(Size);
+		for (int32 Index = Indices.Num() - 1; Index > 0; --Index)
+		{
+			Indices.Swap(Index, Stream.RandRange(0, Index));
+		}
+		TArray<FIntVector> XYZ;
+		XYZ.SetNumUninitialized(Indices.Num());
+		TArray<int32> RoundTrip;
+		RoundTrip.SetNumUninitialized(Indices.Num());
+
+		int64 ScalarSum = 0, BatchSum = 0;
+		const double ScalarTime = TimeBest(Iterations, [&]()
+		{
+			int64 Sum = 0;
+			for (int32 Index = 0; Index < Indices.Num(); ++Index)
+			{
+				XYZ[Index] = FArray3D::TranslateTo3D(Dimensions, Indices[Index]);
+			}
+			for (int32 Index = 0; Index < Indices.Num(); ++Index)
+			{
+				RoundTrip[Index] = FArray3D::TranslateTo1D(Dimensions, XYZ[Index]);
+				Sum += RoundTrip[Index] + XYZ[Index].X + XYZ[Index].Y + XYZ[Index].Z;
+			}
+			return Sum;
+		}, ScalarSum);
+		const double BatchTime = TimeBest(Iterations, [&]()
+		{
+			int64 Sum = 0;
+			FArray3D::TranslateTo3D(Dimensions, Indices, XYZ);
+			FArray3D::TranslateTo1D(Dimensions, XYZ, RoundTrip);
+			for (int32 Index = 0; Index < Indices.Num(); ++Index)
+			{
+				Sum += RoundTrip[Index] + XYZ[Index].X + XYZ[Index].Y + XYZ[Index].Z;
+			}
+			return Sum;
+		}, BatchSum);
+
+		UE_LOG(PicrossEditor, Display, TEXT("%-10s scalar %8.3fms  batch %8.3fms  %5.1fx"), TEXT("Indices"), ScalarTime, BatchTime, ScalarTime / FMath::Max(BatchTime, 1e-6));
+		if (ScalarSum != BatchSum)
+		{
+			UE_LOG(PicrossEditor, Error, TEXT("Indices: the sums don't match (%lld vs %lld)."), ScalarSum, BatchSum);
+			bPassed = false;
+		}
+	}
+
+	// The same scans in every layout at the sizes of the library up to the largest grids the editor handles.
+	UE_LOG(PicrossEditor, Display, TEXT("Comparing layouts, best of %d."), Iterations);
+	for (const int32 LayoutSize : { 10, 16, 32, 64, 128 })
+	{
+		int64 RowMajorChecksum = 0, MortonChecksum = 0, BrickChecksum = 0;
+		BenchmarkLayout<FArray3DRowMajorLayout>(TEXT("RowMajor"), LayoutSize, Iterations, RowMajorChecksum);
+		BenchmarkLayout<FArray3DMortonLayout>(TEXT("Morton"), LayoutSize, Iterations, MortonChecksum);
+		BenchmarkLayout<TArray3DBrickLayout<4>>(TEXT("Brick4"), LayoutSize, Iterations, BrickChecksum);
+
+		if (RowMajorChecksum != MortonChecksum || RowMajorChecksum != BrickChecksum)
+		{
+			UE_LOG(PicrossEditor, Error, TEXT("%d^3: the layouts don't visit the same cells (%lld, %lld, %lld)."), LayoutSize, RowMajorChecksum, MortonChecksum, BrickChecksum);
+			bPassed = false;
+		}
+	}
+
+	// The sizes with their own index math against the generic path, 12^3 goes down the generic path both times as a baseline.
+	UE_LOG(PicrossEditor, Display, TEXT("Comparing fixed and generic index math, best of %d."), Iterations);
+	for (const FIntVector GridSize : { FIntVector(5), FIntVector(10), FIntVector(15), FIntVector(12) })
+	{
+		bPassed &= BenchmarkDispatch(GridSize, Iterations);
+	}
+
+	return bPassed ? 0 : 1;
+}
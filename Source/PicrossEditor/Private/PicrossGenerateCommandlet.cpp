@@ -0,0 +1,106 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossGenerateCommandlet.h"
+#include "PicrossEditor.h"
+#include "AssetRegistryModule.h"
+#include "Math/RandomStream.h"
+#include "Picross/PicrossPuzzleData.h"
+#include "Picross/Solver/PicrossPuzzleGenerator.h"
+
+UPicrossGenerateCommandlet::UPicrossGenerateCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPicrossGenerateCommandlet::Main(const FString& Params)
+{
+	int32 Count = 100;
+	int32 Seed = 0;
+	int32 MinSize = 10;
+	int32 MaxSize = 25;
+	int32 Attempts = 16;
+	int32 BatchSize = 64;
+	FString Path = TEXT("/Game/Static/PicrossPuzzles/Generated");
+	FPicrossGeneratorSettings BaseSettings;
+	FParse::Value(*Params, TEXT("Count="), Count);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("MinSize="), MinSize);
+	FParse::Value(*Params, TEXT("MaxSize="), MaxSize);
+	FParse::Value(*Params, TEXT("Attempts="), Attempts);
+	FParse::Value(*Params, TEXT("BatchSize="), BatchSize);
+	FParse::Value(*Params, TEXT("Path="), Path);
+	FParse::Value(*Params, TEXT("Density="), BaseSettings.Density);
+	FParse::Value(*Params, TEXT("NoiseScale="), BaseSettings.NoiseScale);
+	FParse::Value(*Params, TEXT("MinDifficulty="), BaseSettings.MinDifficulty);
+	FParse::Value(*Params, TEXT("MaxDifficulty="), BaseSettings.MaxDifficulty);
+	FParse::Value(*Params, TEXT("TimeLimit="), BaseSettings.VerifierTimeLimitSeconds);
+	BaseSettings.Shape = FParse::Param(*Params, TEXT("Random")) ? EPicrossGeneratorShape::Random : EPicrossGeneratorShape::Noise;
+
+	MaxSize = FMath::Min(MaxSize, FPicrossLineMask::MaxLength);
+	MinSize = FMath::Clamp(MinSize, 1, MaxSize);
+	BatchSize = FMath::Max(BatchSize, 1);
+
+	// The sizes are drawn up front from their own stream so they don't depend on the batching either.
+	FRandomStream SizeStream(Seed);
+	TArray<FPicrossGeneratorSettings> Settings;
+	Settings.Init(BaseSettings, Count);
+	for (FPicrossGeneratorSettings& PuzzleSettings : Settings)
+	{
+		PuzzleSettings.GridSize = FIntVector(SizeStream.RandRange(MinSize, MaxSize));
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 GeneratedPuzzles = 0;
+	int32 FailedPuzzles = 0;
+	int32 FailedSaves = 0;
+	for (int32 BatchStart = 0; BatchStart < Count; BatchStart += BatchSize)
+	{
+		const int32 BatchCount = FMath::Min(BatchSize, Count - BatchStart);
+		const TArray<FPicrossGeneratedPuzzle> Puzzles = FPicrossPuzzleGenerator::GenerateMany(MakeArrayView(Settings.GetData() + BatchStart, BatchCount), Seed, BatchStart, Attempts);
+
+		// Creating and saving the assets has to happen on the game thread.
+		for (int32 Index = 0; Index < Puzzles.Num(); ++Index)
+		{
+			const FPicrossGeneratedPuzzle& Puzzle = Puzzles[Index];
+			if (Puzzle.Solution.Num() == 0)
+			{
+				UE_LOG(PicrossEditor, Warning, TEXT("Puzzle %d failed after %d attempts."), BatchStart + Index, Attempts);
+				++FailedPuzzles;
+				continue;
+			}
+
+			const FString AssetName = FString::Printf(TEXT("DA_Puzzle_Gen_%d_%05d"), Seed, BatchStart + Index);
+			const FString PackageName = Path / AssetName;
+			UPackage* Package = CreatePackage(nullptr, *PackageName);
+			UPicrossPuzzleData* PuzzleData = NewObject<UPicrossPuzzleData>(Package, *AssetName, RF_Public | RF_Standalone);
+			PuzzleData->SetGridSize(Puzzle.GridSize);
+			PuzzleData->SetSolution(Puzzle.Solution);
+			PuzzleData->SetDifficulty(Puzzle.Rating.Score);
+			FAssetRegistryModule::AssetCreated(PuzzleData);
+
+			Package->MarkPackageDirty();
+			const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+			if (UPackage::SavePackage(Package, PuzzleData, RF_Public | RF_Standalone, *Filename))
+			{
+				UE_LOG(PicrossEditor, Display, TEXT("%s: %s"), *AssetName, *Puzzle.Rating.ToString());
+				++GeneratedPuzzles;
+			}
+			else
+			{
+				UE_LOG(PicrossEditor, Error, TEXT("Failed to save %s."), *Filename);
+				++FailedSaves;
+			}
+		}
+
+		// The saved puzzles aren't needed anymore, letting them go keeps the memory flat over a long run.
+		CollectGarbage(RF_NoFlags);
+		UE_LOG(PicrossEditor, Display, TEXT("%d of %d puzzles done after %.1fs."), BatchStart + BatchCount, Count, FPlatformTime::Seconds() - StartTime);
+	}
+
+	UE_LOG(PicrossEditor, Display, TEXT("Generated %d puzzles in %.1fs, %d couldn't be generated and %d couldn't be saved."), GeneratedPuzzles, FPlatformTime::Seconds() - StartTime, FailedPuzzles, FailedSaves);
+	return FailedPuzzles > 0 || FailedSaves > 0 ? 1 : 0;
+}
@@ -3,18 +3,48 @@
 extern UNREALED_API class UEditorEngine* GEditor;
 
 #include "PicrossGridCreator.h"
+#include "PicrossEditor.h"
 #include "PicrossPuzzleFactory.h"
 #include "AssetToolsModule.h"
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Editor/EditorEngine.h"
+#include "Misc/MessageDialog.h"
 
+#define LOCTEXT_NAMESPACE "PicrossGridCreator"
+
+
+APicrossGridCreator::APicrossGridCreator()
+{
+	AmbiguousBlocks = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Ambiguous Blocks"));
+	if (AmbiguousBlocks)
+	{
+		AmbiguousBlocks->SetupAttachment(GetRootComponent());
+	}
+}
 
 void APicrossGridCreator::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (AmbiguousBlocks && AmbiguousMesh && AmbiguousMaterial)
+	{
+		AmbiguousBlocks->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		AmbiguousBlocks->SetStaticMesh(AmbiguousMesh);
+		AmbiguousBlocks->SetMaterial(0, AmbiguousMaterial);
+	}
+
 	CreatePuzzle();
 }
 
+void APicrossGridCreator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	CancelLiveUniquenessCheck();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void APicrossGridCreator::CreatePuzzle()
 {
 	CreatePuzzleWithSize(GridSize);
@@ -27,6 +57,9 @@ void APicrossGridCreator::CreatePuzzleWithSize(FIntVector SizeOfGrid)
 	Puzzle = FPicrossPuzzle(PuzzleData);
 	CreateGrid();
 	SolutionFilledBlocksCount = -1;
+
+	ResetLiveClues();
+	RestartLiveUniquenessCheck();
 }
 
 void APicrossGridCreator::SavePuzzle()
@@ -35,13 +68,15 @@ void APicrossGridCreator::SavePuzzle()
 
 	UPicrossPuzzleData* PuzzleData = Puzzle.GetPuzzleData();
 	TArray<bool> Solution;
-
-	for (const FPicrossBlock& Block : Puzzle)
+	Solution.Init(false, Puzzle.Num());
+	Puzzle.GetStates().ForEachChanged([&Solution](int32 MasterIndex, EBlockState State)
 	{
-		Solution.Add(Block.State == EBlockState::Filled);
-	}
+		Solution[MasterIndex] = State == EBlockState::Filled;
+	});
 	PuzzleData->SetSolution(Solution);
 
+	if (!VerifyUniqueness(*PuzzleData)) return;
+
 	UPicrossPuzzleFactory* NewFactory = NewObject<UPicrossPuzzleFactory>();
 	NewFactory->CreatedObjectAsset = PuzzleData;
 
@@ -50,4 +85,164 @@ void APicrossGridCreator::SavePuzzle()
 	TArray<UObject*> ObjectsToSync;
 	ObjectsToSync.Add(NewAsset);
 	GEditor->SyncBrowserToObjects(ObjectsToSync);
-}
\ No newline at end of file
+}
+
+bool APicrossGridCreator::VerifyUniqueness(const UPicrossPuzzleData& PuzzleData) const
+{
+	FPicrossVerifierOptions Options;
+	Options.TimeLimitSeconds = UniquenessTimeLimit;
+
+	FPicrossUniquenessResult Uniqueness;
+	if (!FPicrossUniquenessVerifier::Verify(PuzzleData, Uniqueness, Options))
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("InvalidPuzzle", "The puzzle is not valid and can't be saved."));
+		return false;
+	}
+
+	UE_LOG(PicrossEditor, Log, TEXT("Uniqueness check finished with result %d after %lld decisions. %s"), static_cast<int32>(Uniqueness.Result), Uniqueness.Decisions, *Uniqueness.Stats.ToString());
+
+	switch (Uniqueness.Result)
+	{
+		case EPicrossUniqueness::Unique:
+			return true;
+		case EPicrossUniqueness::Multiple:
+			FMessageDialog::Open(EAppMsgType::Ok, FText::Format(LOCTEXT("MultipleSolutions", "The clues of the puzzle have more than one solution, {0} cells differ between two of them. The puzzle was not saved."), FText::AsNumber(Uniqueness.GetAmbiguousCells().Num())));
+			return false;
+		case EPicrossUniqueness::Unsolvable:
+			FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("Unsolvable", "The clues of the puzzle have no solution. The puzzle was not saved."));
+			return false;
+		case EPicrossUniqueness::Undetermined:
+		default:
+			return FMessageDialog::Open(EAppMsgType::YesNo, FText::Format(LOCTEXT("Undetermined", "Couldn't decide whether the puzzle has a unique solution within {0} seconds. Save it anyway?"), FText::AsNumber(UniquenessTimeLimit))) == EAppReturnType::Yes;
+	}
+}
+
+void APicrossGridCreator::HandleBlocksChanged(TArrayView<const int32> ChangedBlocks)
+{
+	Super::HandleBlocksChanged(ChangedBlocks);
+
+	UpdateLiveClues(ChangedBlocks);
+	RestartLiveUniquenessCheck();
+}
+
+void APicrossGridCreator::ResetLiveClues()
+{
+	LiveSolution.Reset();
+	LiveClues.Reset();
+	if (!Puzzle.IsValid()) return;
+
+	LiveSolution.Init(false, Puzzle.Num());
+	Puzzle.GetStates().ForEachChanged([this](int32 MasterIndex, EBlockState State)
+	{
+		LiveSolution[MasterIndex] = State == EBlockState::Filled;
+	});
+	LiveClues = MakeShared<FPicrossPuzzleClues, ESPMode::ThreadSafe>();
+	if (!LiveClues->Generate(Puzzle.GetGridSize(), LiveSolution)) return;
+	// Every edit then writes its lines in place.
+	LiveClues->ReserveLineSlack();
+
+	for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+	{
+		const FPicrossLineLayout Layout(LiveClues->GridSize, Axis);
+		for (int32 LineIndex = 0; LineIndex < Layout.Num(); ++LineIndex)
+		{
+			UpdateNumbersForLine(Axis, LineIndex % Layout.Axis1Size, LineIndex / Layout.Axis1Size, LiveClues->GetClue(Axis, LineIndex));
+		}
+	}
+}
+
+void APicrossGridCreator::UpdateLiveClues(TArrayView<const int32> ChangedBlocks)
+{
+	// The grid was replaced without going through CreatePuzzleWithSize, for example by loading a puzzle.
+	if (LiveSolution.Num() != Puzzle.Num() || !LiveClues.IsValid() || LiveClues->GridSize != Puzzle.GetGridSize())
+	{
+		ResetLiveClues();
+		return;
+	}
+
+	for (const int32 MasterIndex : ChangedBlocks)
+	{
+		LiveSolution[MasterIndex] = Puzzle.GetState(MasterIndex) == EBlockState::Filled;
+	}
+
+	// A cancelled check can still be reading the clues, they're only copied then.
+	if (!LiveClues.IsUnique())
+	{
+		LiveClues = MakeShared<FPicrossPuzzleClues, ESPMode::ThreadSafe>(*LiveClues);
+	}
+
+	TArray<TPair<EAxis::Type, int32>> ChangedLines;
+	LiveClues->Update(LiveSolution, ChangedBlocks, &ChangedLines);
+	for (const TPair<EAxis::Type, int32>& Line : ChangedLines)
+	{
+		const FPicrossLineLayout Layout(LiveClues->GridSize, Line.Key);
+		UpdateNumbersForLine(Line.Key, Line.Value % Layout.Axis1Size, Line.Value / Layout.Axis1Size, LiveClues->GetClue(Line.Key, Line.Value));
+	}
+}
+
+void APicrossGridCreator::RestartLiveUniquenessCheck()
+{
+	CancelLiveUniquenessCheck();
+	ShowAmbiguousBlocks({});
+	LiveUniqueness = EPicrossUniqueness::Undetermined;
+
+	if (!bLiveUniquenessCheck || LiveSolution.Num() == 0 || !LiveClues.IsValid()) return;
+
+	// The line cache outlives the checks so lines untouched by the edit are solved from the previous check.
+	if (!LiveLineCache.IsValid())
+	{
+		LiveLineCache = MakeShared<FPicrossLineCache, ESPMode::ThreadSafe>();
+	}
+
+	// The check shares the clues, the next edit copies them only if the check still holds them by then.
+	LiveUniquenessCancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+	FFunctionGraphTask::CreateAndDispatchWhenReady([Clues = TSharedPtr<const FPicrossPuzzleClues, ESPMode::ThreadSafe>(LiveClues), CancelFlag = LiveUniquenessCancelFlag, LineCache = LiveLineCache, TimeLimit = LiveUniquenessTimeLimit, WeakThis = TWeakObjectPtr<APicrossGridCreator>(this)]()
+	{
+		// A single worker keeps the background check from taking every core away from the editor.
+		FPicrossVerifierOptions Options;
+		Options.NumWorkers = 1;
+		Options.Cache = LineCache.Get();
+		Options.TimeLimitSeconds = TimeLimit;
+		Options.CancelFlag = CancelFlag.Get();
+		const FPicrossUniquenessResult Uniqueness = FPicrossUniquenessVerifier::Verify(*Clues, Options);
+		if (*CancelFlag) return;
+
+		AsyncTask(ENamedThreads::GameThread, [CancelFlag, WeakThis, Result = Uniqueness.Result, AmbiguousCells = Uniqueness.GetAmbiguousCells(), Decisions = Uniqueness.Decisions]()
+		{
+			APicrossGridCreator* Creator = WeakThis.Get();
+			if (*CancelFlag || !Creator) return;
+
+			UE_LOG(PicrossEditor, Verbose, TEXT("Live uniqueness check finished with result %d after %lld decisions, %d ambiguous cells."), static_cast<int32>(Result), Decisions, AmbiguousCells.Num());
+			Creator->LiveUniqueness = Result;
+			Creator->ShowAmbiguousBlocks(AmbiguousCells);
+		});
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+void APicrossGridCreator::CancelLiveUniquenessCheck()
+{
+	if (LiveUniquenessCancelFlag.IsValid())
+	{
+		*LiveUniquenessCancelFlag = true;
+		LiveUniquenessCancelFlag.Reset();
+	}
+}
+
+void APicrossGridCreator::ShowAmbiguousBlocks(TArrayView<const int32> AmbiguousCells)
+{
+	if (!AmbiguousBlocks) return;
+
+	AmbiguousBlocks->ClearInstances();
+	for (const int32 MasterIndex : AmbiguousCells)
+	{
+		if (!Puzzle.IsValidIndex(MasterIndex)) continue;
+
+		const FTransform BlockTransform = Puzzle.GetBlockTransform(MasterIndex);
+		FTransform AmbiguousBlockTransform = BlockTransform;
+		AmbiguousBlockTransform.SetScale3D(AmbiguousBlockTransform.GetScale3D() * 1.1f);
+		AmbiguousBlockTransform.AddToTranslation((-GetActorUpVector()) * 100.f * ((AmbiguousBlockTransform.GetScale3D().Z - BlockTransform.GetScale3D().Z) / 2));
+		AmbiguousBlocks->AddInstanceWorldSpace(AmbiguousBlockTransform);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
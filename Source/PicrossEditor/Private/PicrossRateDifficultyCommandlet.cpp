@@ -0,0 +1,65 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossRateDifficultyCommandlet.h"
+#include "PicrossEditor.h"
+#include "AssetRegistryModule.h"
+#include "Picross/PicrossPuzzleData.h"
+#include "Picross/Solver/PicrossDifficultyRater.h"
+
+UPicrossRateDifficultyCommandlet::UPicrossRateDifficultyCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPicrossRateDifficultyCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	ParseCommandLine(*Params, Tokens, Switches);
+	const bool bForce = Switches.Contains(TEXT("force"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+	TArray<FAssetData> AssetDatas;
+	AssetRegistry.GetAssetsByClass(UPicrossPuzzleData::StaticClass()->GetFName(), AssetDatas);
+
+	// Loading has to happen on the game thread, only the rating itself goes wide.
+	TArray<UPicrossPuzzleData*> Puzzles;
+	TArray<float> PreviousDifficulties;
+	for (const FAssetData& AssetData : AssetDatas)
+	{
+		if (UPicrossPuzzleData* PuzzleData = Cast<UPicrossPuzzleData>(AssetData.GetAsset()))
+		{
+			Puzzles.Add(PuzzleData);
+			PreviousDifficulties.Add(PuzzleData->GetDifficulty());
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 RatedPuzzles = FPicrossDifficultyRater::RateAll(Puzzles, !bForce);
+	UE_LOG(PicrossEditor, Display, TEXT("Rated %d of %d puzzles in %.2fs."), RatedPuzzles, Puzzles.Num(), FPlatformTime::Seconds() - StartTime);
+
+	int32 FailedSaves = 0;
+	for (int32 Index = 0; Index < Puzzles.Num(); ++Index)
+	{
+		UPicrossPuzzleData* PuzzleData = Puzzles[Index];
+		if (PuzzleData->GetDifficulty() == PreviousDifficulties[Index]) continue;
+
+		UE_LOG(PicrossEditor, Display, TEXT("%s: %.1f -> %.1f"), *PuzzleData->GetName(), PreviousDifficulties[Index], PuzzleData->GetDifficulty());
+
+		UPackage* Package = PuzzleData->GetOutermost();
+		Package->MarkPackageDirty();
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		if (!UPackage::SavePackage(Package, PuzzleData, RF_Public | RF_Standalone, *Filename))
+		{
+			UE_LOG(PicrossEditor, Error, TEXT("Failed to save %s."), *Filename);
+			++FailedSaves;
+		}
+	}
+
+	return FailedSaves > 0 ? 1 : 0;
+}
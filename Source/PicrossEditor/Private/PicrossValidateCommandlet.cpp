@@ -0,0 +1,300 @@
+// Copyright Sanya Larsson 2020
+
+
+#include "PicrossValidateCommandlet.h"
+#include "PicrossEditor.h"
+#include "AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Picross/PicrossBlock.h"
+#include "Picross/PicrossPuzzleData.h"
+#include "Picross/Solver/PicrossUniquenessVerifier.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	struct FPuzzleReport
+	{
+		FString Name;
+		FString PackageName;
+		FIntVector GridSize;
+		FPicrossSolution Solution;
+
+		TArray<FString> Errors;
+		EPicrossUniqueness Uniqueness = EPicrossUniqueness::Undetermined;
+		bool bNeedsGuessing = false;
+		int64 Decisions = 0;
+		bool bLoaded = false;
+		// Hash of the solution as is and the smallest hash over all rotations and mirrors of it, only set if bHashed.
+		bool bHashed = false;
+		uint64 ExactHash = 0;
+		uint64 CanonicalHash = 0;
+		double Seconds = 0.0;
+	};
+
+	const TCHAR* LexToString(EPicrossUniqueness Uniqueness)
+	{
+		switch (Uniqueness)
+		{
+			case EPicrossUniqueness::Unique: return TEXT("Unique");
+			case EPicrossUniqueness::Multiple: return TEXT("Multiple");
+			case EPicrossUniqueness::Unsolvable: return TEXT("Unsolvable");
+			default: return TEXT("Undetermined");
+		}
+	}
+
+	/**
+	 * Hashes the solution as seen through one of the 48 rotations and mirrors of the grid.
+	 * @param Permutation - The original axis each axis of the transformed grid runs along.
+	 * @param Mirror - Bit N set mirrors axis N of the transformed grid.
+	 */
+	uint64 HashTransformed(FIntVector GridSize, const FPicrossSolution& Solution, const int32 (&Permutation)[3], int32 Mirror)
+	{
+		const FIntVector Size(GridSize[Permutation[0]], GridSize[Permutation[1]], GridSize[Permutation[2]]);
+		TArray<uint8> Bytes;
+		Bytes.SetNumZeroed(sizeof(FIntVector) + (Solution.Num() + 7) / 8);
+		FMemory::Memcpy(Bytes.GetData(), &Size, sizeof(FIntVector));
+		uint8* Bits = Bytes.GetData() + sizeof(FIntVector);
+
+		int32 Bit = 0;
+		for (int32 Z = 0; Z < Size.Z; ++Z)
+		{
+			for (int32 Y = 0; Y < Size.Y; ++Y)
+			{
+				for (int32 X = 0; X < Size.X; ++X, ++Bit)
+				{
+					const int32 Transformed[3] = { X, Y, Z };
+					FIntVector Original;
+					for (int32 Axis = 0; Axis < 3; ++Axis)
+					{
+						Original[Permutation[Axis]] = (Mirror >> Axis) & 1 ? Size[Axis] - 1 - Transformed[Axis] : Transformed[Axis];
+					}
+					if (Solution[FArray3D::TranslateTo1D(GridSize, Original)])
+					{
+						Bits[Bit >> 3] |= 1 << (Bit & 7);
+					}
+				}
+			}
+		}
+		return CityHash64(reinterpret_cast<const char*>(Bytes.GetData()), Bytes.Num());
+	}
+
+	void HashSolution(FPuzzleReport& Report)
+	{
+		static const int32 Permutations[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+		Report.ExactHash = HashTransformed(Report.GridSize, Report.Solution, Permutations[0], 0);
+		Report.CanonicalHash = Report.ExactHash;
+		for (const int32 (&Permutation)[3] : Permutations)
+		{
+			for (int32 Mirror = 0; Mirror < 8; ++Mirror)
+			{
+				Report.CanonicalHash = FMath::Min(Report.CanonicalHash, HashTransformed(Report.GridSize, Report.Solution, Permutation, Mirror));
+			}
+		}
+		Report.bHashed = true;
+	}
+
+	void ValidatePuzzle(FPuzzleReport& Report, double TimeLimitSeconds, bool bRequireLogic)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		ON_SCOPE_EXIT { Report.Seconds = FPlatformTime::Seconds() - StartTime; };
+
+		FPicrossPuzzleClues Clues;
+		if (!Clues.Generate(Report.GridSize, Report.Solution))
+		{
+			Report.Errors.Add(FString::Printf(TEXT("Invalid dimensions (%d, %d, %d) for %d cells, every side has to be between 1 and %d."),
+				Report.GridSize.X, Report.GridSize.Y, Report.GridSize.Z, Report.Solution.Num(), FPicrossLineMask::MaxLength));
+			return;
+		}
+
+		HashSolution(Report);
+
+		for (const EAxis::Type Axis : { EAxis::X, EAxis::Y, EAxis::Z })
+		{
+			bool bHasClues = false;
+			for (int32 LineIndex = 0; LineIndex < Clues.NumLines(Axis) && !bHasClues; ++LineIndex)
+			{
+				bHasClues = Clues.GetClue(Axis, LineIndex).Num() > 0;
+			}
+			if (!bHasClues)
+			{
+				Report.Errors.Add(FString::Printf(TEXT("The %s axis has no clues."), Axis == EAxis::X ? TEXT("X") : Axis == EAxis::Y ? TEXT("Y") : TEXT("Z")));
+			}
+		}
+
+		// Every puzzle is validated on its own thread, so each verifier stays single-threaded.
+		FPicrossVerifierOptions Options;
+		Options.NumWorkers = 1;
+		Options.TimeLimitSeconds = TimeLimitSeconds;
+		const FPicrossUniquenessResult Result = FPicrossUniquenessVerifier::Verify(Clues, Options);
+		Report.Uniqueness = Result.Result;
+		Report.Decisions = Result.Decisions;
+		Report.bNeedsGuessing = Result.Decisions > 0;
+
+		switch (Result.Result)
+		{
+			case EPicrossUniqueness::Unique:
+			{
+				FPicrossSolution FoundSolution;
+				FoundSolution.Init(Result.Solution.Num());
+				for (int32 Index = 0; Index < Result.Solution.Num(); ++Index)
+				{
+					FoundSolution.Set(Index, Result.Solution[Index] == EBlockState::Filled);
+				}
+				if (FoundSolution != Report.Solution)
+				{
+					Report.Errors.Add(TEXT("The only solution of the clues differs from the stored solution."));
+				}
+				break;
+			}
+			case EPicrossUniqueness::Multiple:
+				Report.Errors.Add(FString::Printf(TEXT("The clues have more than one solution, %d cells are ambiguous."), Result.GetAmbiguousCells().Num()));
+				break;
+			case EPicrossUniqueness::Unsolvable:
+				Report.Errors.Add(TEXT("The clues have no solution."));
+				break;
+			default:
+				Report.Errors.Add(FString::Printf(TEXT("Couldn't decide whether the clues have a unique solution within %.1fs."), TimeLimitSeconds));
+				break;
+		}
+
+		if (bRequireLogic && Report.bNeedsGuessing)
+		{
+			Report.Errors.Add(TEXT("The puzzle can't be solved without guessing."));
+		}
+	}
+
+	TSharedRef<FJsonObject> ToJson(const FPuzzleReport& Report)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("name"), Report.Name);
+		Object->SetStringField(TEXT("package"), Report.PackageName);
+
+		TArray<TSharedPtr<FJsonValue>> GridSize;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			GridSize.Add(MakeShared<FJsonValueNumber>(Report.GridSize[Axis]));
+		}
+		Object->SetArrayField(TEXT("gridSize"), GridSize);
+		Object->SetBoolField(TEXT("passed"), Report.Errors.Num() == 0);
+		Object->SetBoolField(TEXT("loaded"), Report.bLoaded);
+		Object->SetStringField(TEXT("uniqueness"), LexToString(Report.Uniqueness));
+		Object->SetBoolField(TEXT("needsGuessing"), Report.bNeedsGuessing);
+		Object->SetNumberField(TEXT("decisions"), Report.Decisions);
+		Object->SetNumberField(TEXT("milliseconds"), Report.Seconds * 1000.0);
+
+		TArray<TSharedPtr<FJsonValue>> Errors;
+		for (const FString& Error : Report.Errors)
+		{
+			Errors.Add(MakeShared<FJsonValueString>(Error));
+		}
+		Object->SetArrayField(TEXT("errors"), Errors);
+		return Object;
+	}
+}
+
+UPicrossValidateCommandlet::UPicrossValidateCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPicrossValidateCommandlet::Main(const FString& Params)
+{
+	FString ReportPath = FPaths::ProjectSavedDir() / TEXT("PicrossValidation.json");
+	double TimeLimitSeconds = 60.0;
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+	FParse::Value(*Params, TEXT("TimeLimit="), TimeLimitSeconds);
+	const bool bRequireLogic = FParse::Param(*Params, TEXT("RequireLogic"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+	TArray<FAssetData> AssetDatas;
+	AssetRegistry.GetAssetsByClass(UPicrossPuzzleData::StaticClass()->GetFName(), AssetDatas);
+
+	// Loading has to happen on the game thread, the validation only works on copies of the solutions.
+	TArray<FPuzzleReport> Reports;
+	TArray<int32> LoadedReports;
+	for (const FAssetData& AssetData : AssetDatas)
+	{
+		FPuzzleReport& Report = Reports.AddDefaulted_GetRef();
+		Report.Name = AssetData.AssetName.ToString();
+		Report.PackageName = AssetData.PackageName.ToString();
+		if (const UPicrossPuzzleData* PuzzleData = Cast<UPicrossPuzzleData>(AssetData.GetAsset()))
+		{
+			Report.bLoaded = true;
+			Report.GridSize = PuzzleData->GetGridSize();
+			Report.Solution = PuzzleData->GetSolution();
+			LoadedReports.Add(Reports.Num() - 1);
+		}
+		else
+		{
+			// Reported as failed without validating, an unloaded puzzle has no grid to validate.
+			Report.Errors.Add(TEXT("Failed to load the puzzle."));
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	ParallelFor(LoadedReports.Num(), [&](int32 Index)
+	{
+		ValidatePuzzle(Reports[LoadedReports[Index]], TimeLimitSeconds, bRequireLogic);
+	});
+
+	TMap<uint64, int32> FirstWithHash;
+	for (int32 Index = 0; Index < Reports.Num(); ++Index)
+	{
+		FPuzzleReport& Report = Reports[Index];
+		if (!Report.bHashed) continue;
+
+		if (const int32* Original = FirstWithHash.Find(Report.CanonicalHash))
+		{
+			const FPuzzleReport& OriginalReport = Reports[*Original];
+			Report.Errors.Add(FString::Printf(TEXT("Duplicate of %s%s."), *OriginalReport.Name, OriginalReport.ExactHash == Report.ExactHash ? TEXT("") : TEXT(" when rotated or mirrored")));
+		}
+		else
+		{
+			FirstWithHash.Add(Report.CanonicalHash, Index);
+		}
+	}
+	const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+	int32 FailedPuzzles = 0;
+	TArray<TSharedPtr<FJsonValue>> PuzzleValues;
+	for (const FPuzzleReport& Report : Reports)
+	{
+		PuzzleValues.Add(MakeShared<FJsonValueObject>(ToJson(Report)));
+		if (Report.Errors.Num() > 0)
+		{
+			++FailedPuzzles;
+			for (const FString& Error : Report.Errors)
+			{
+				UE_LOG(PicrossEditor, Error, TEXT("%s: %s"), *Report.Name, *Error);
+			}
+		}
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField(TEXT("puzzles"), Reports.Num());
+	Root->SetNumberField(TEXT("failed"), FailedPuzzles);
+	Root->SetNumberField(TEXT("milliseconds"), TotalSeconds * 1000.0);
+	Root->SetArrayField(TEXT("results"), PuzzleValues);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+	if (!FFileHelper::SaveStringToFile(Json, *ReportPath))
+	{
+		UE_LOG(PicrossEditor, Error, TEXT("Failed to write the report to %s."), *ReportPath);
+		return 1;
+	}
+
+	UE_LOG(PicrossEditor, Display, TEXT("Validated %d puzzles in %.2fs, %d failed. Report written to %s."), Reports.Num(), TotalSeconds, FailedPuzzles, *ReportPath);
+	return FailedPuzzles > 0 ? 1 : 0;
+}
@@ -0,0 +1,27 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PicrossBenchmarkCommandlet.generated.h"
+
+/**
+ * Times walking a 3D grid the way the grid code does it against the views of TArray3D and logs the best time of each.
+ * Also times converting every index of the grid one at a time against the batch conversions of FArray3D.
+ * Then times line scans, slice scans and box fills in the row-major, Morton and brick layouts from 10^3 to 128^3.
+ * Last times clue generation and propagation with the fixed-size index math of FPicrossGridDispatch against the generic path.
+ * Every case sums the cells it visits, the sums have to match for the timings to count.
+ * Usage: UE4Editor-Cmd.exe Picross.uproject -run=PicrossBenchmark [-Size=64] [-Iterations=20]
+ * @returns 0 if every case visited the same cells every way and 1 otherwise.
+ */
+UCLASS()
+class PICROSSEDITOR_API UPicrossBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPicrossBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,25 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PicrossGenerateCommandlet.generated.h"
+
+/**
+ * Generates uniquely solvable puzzles in bulk and saves them as assets.
+ * The candidates are generated in parallel in batches, each batch is saved before the next one starts so an interrupted run keeps what it made.
+ * Usage: UE4Editor-Cmd.exe Picross.uproject -run=PicrossGenerate [-Count=100] [-Seed=0] [-MinSize=10] [-MaxSize=25] [-Density=0.5] [-Random] [-NoiseScale=4]
+ *        [-MinDifficulty=0] [-MaxDifficulty=-1] [-Attempts=16] [-TimeLimit=5] [-BatchSize=64] [-Path=/Game/Static/PicrossPuzzles/Generated]
+ * The same arguments always give the same puzzles.
+ */
+UCLASS()
+class PICROSSEDITOR_API UPicrossGenerateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPicrossGenerateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
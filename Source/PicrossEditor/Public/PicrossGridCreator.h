@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Picross/PicrossGrid.h"
+#include "Picross/Solver/PicrossUniquenessVerifier.h"
 #include "PicrossGridCreator.generated.h"
 
 /**
@@ -15,6 +16,8 @@ class PICROSSEDITOR_API APicrossGridCreator : public APicrossGrid
 	GENERATED_BODY()
 
 public:
+	APicrossGridCreator();
+
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Picross")
 	void CreatePuzzle();
 	UFUNCTION(BlueprintCallable, Category = "Picross")
@@ -25,8 +28,57 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void HandleBlocksChanged(TArrayView<const int32> ChangedBlocks) override;
 
 private:
+	// Makes sure the clues of the puzzle have exactly one solution, telling the user why not otherwise.
+	bool VerifyUniqueness(const UPicrossPuzzleData& PuzzleData) const;
+
+	/**
+	 * Rebuilds the live clues and numbers of the whole grid, only needed when the grid is created.
+	 */
+	void ResetLiveClues();
+	/**
+	 * Updates the live clues and numbers of the lines passing through the changed blocks.
+	 */
+	void UpdateLiveClues(TArrayView<const int32> ChangedBlocks);
+
+	/**
+	 * Cancels the running uniqueness check and starts a new one for the current clues on the task graph.
+	 */
+	void RestartLiveUniquenessCheck();
+	void CancelLiveUniquenessCheck();
+	void ShowAmbiguousBlocks(TArrayView<const int32> AmbiguousCells);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross", meta = (AllowPrivateAccess = "true"))
 	FIntVector GridSize{ 5, 5, 5 };
+
+	// The longest time in seconds the uniqueness check may take when saving before asking whether to save anyway.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float UniquenessTimeLimit = 30.f;
+
+	// Whether to check the uniqueness of the puzzle in the background after every edit.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross", meta = (AllowPrivateAccess = "true"))
+	bool bLiveUniquenessCheck = true;
+	// The longest time in seconds the background uniqueness check may take, it's restarted on every edit anyway.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	float LiveUniquenessTimeLimit = 10.f;
+
+	// Marks the cells two solutions of the current clues disagree on.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
+	UStaticMesh* AmbiguousMesh = nullptr;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Picross Block", meta = (AllowPrivateAccess = "true"))
+	UMaterialInstance* AmbiguousMaterial = nullptr;
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* AmbiguousBlocks = nullptr;
+
+	// The filled blocks and their clues, kept up to date on every edit instead of when saving.
+	TArray<bool> LiveSolution;
+	// Shared with the running uniqueness check, an edit only copies the clues while a check still holds them.
+	TSharedPtr<FPicrossPuzzleClues, ESPMode::ThreadSafe> LiveClues;
+	EPicrossUniqueness LiveUniqueness = EPicrossUniqueness::Undetermined;
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> LiveUniquenessCancelFlag;
+	// Shared with the running check, which keeps it alive if the creator is destroyed first.
+	TSharedPtr<FPicrossLineCache, ESPMode::ThreadSafe> LiveLineCache;
 };
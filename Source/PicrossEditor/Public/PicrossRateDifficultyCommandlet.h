@@ -0,0 +1,24 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PicrossRateDifficultyCommandlet.generated.h"
+
+/**
+ * Rates the difficulty of every puzzle in parallel and saves the puzzles whose score changed.
+ * Run it before cooking so the puzzles don't have to be rated one at a time as they are saved.
+ * Usage: UE4Editor-Cmd.exe Picross.uproject -run=PicrossRateDifficulty [-force]
+ * -force rates puzzles that already have a score as well.
+ */
+UCLASS()
+class PICROSSEDITOR_API UPicrossRateDifficultyCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPicrossRateDifficultyCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
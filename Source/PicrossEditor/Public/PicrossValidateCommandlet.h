@@ -0,0 +1,26 @@
+// Copyright Sanya Larsson 2020
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PicrossValidateCommandlet.generated.h"
+
+/**
+ * Validates every puzzle in parallel and writes a JSON report with the result and timing of each puzzle.
+ * Checks the dimensions, that no axis is without clues, that the clues are solvable and have a unique solution matching the stored one,
+ * and that no puzzle is a copy of another one, also when rotated or mirrored.
+ * Usage: UE4Editor-Cmd.exe Picross.uproject -run=PicrossValidate [-Report=<file>] [-TimeLimit=60] [-RequireLogic]
+ * -RequireLogic also fails puzzles that can't be solved without guessing.
+ * @returns 0 if every puzzle passed and 1 otherwise.
+ */
+UCLASS()
+class PICROSSEDITOR_API UPicrossValidateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPicrossValidateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};